@@ -518,6 +518,13 @@ COPY Passenger(id, flight_id, barcode) from stdin;
 23	7	1J3H3J3K3L3M
 \.
 SELECT setval('passenger_id_seq', 24);
+
+-- indexes, run on their own to bring an existing database up to date
+\ir migrations/001_indexes.sql
+\ir migrations/002_reference_notify.sql
+\ir migrations/003_flight_notify.sql
+\ir migrations/004_flight_counters.sql
+
 -- permissions
 CREATE USER admin WITH LOGIN PASSWORD 'password';
 GRANT ALL ON DATABASE airport TO admin;
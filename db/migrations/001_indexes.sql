@@ -0,0 +1,26 @@
+-- Indexes for the lookups every Operation makes
+-- primary keys and the UNIQUE columns (LocationType.icao, Passenger.barcode)
+-- are already indexed, so only the foreign keys and filters are covered here
+
+-- every command resolves its flight by number, newest first
+CREATE INDEX IF NOT EXISTS flight_number_idx ON Flight (flight_number, departure_time DESC);
+
+-- depart / arrive only look at flights that have not arrived or been cancelled
+-- (status ids 6 and 7), the statements repeat this predicate so these match
+-- and the shell refuses to start when StatusType has other ids for them
+CREATE INDEX IF NOT EXISTS flight_active_origin_idx ON Flight (origin_id) WHERE status_id NOT IN (6, 7);
+CREATE INDEX IF NOT EXISTS flight_active_destination_idx ON Flight (destination_id) WHERE status_id NOT IN (6, 7);
+
+-- list walks flights that have not arrived in departure order, id breaks ties
+DROP INDEX IF EXISTS flight_departure_idx;
+CREATE INDEX IF NOT EXISTS flight_departure_id_idx ON Flight (departure_time, id) WHERE status_id <> 6;
+
+-- per flight cargo totals and removal by barcode
+CREATE INDEX IF NOT EXISTS cargo_flight_idx ON Cargo (flight_id, barcode);
+
+-- passenger counts and removing the most recently boarded
+CREATE INDEX IF NOT EXISTS passenger_flight_idx ON Passenger (flight_id, id);
+
+ANALYZE Flight;
+ANALYZE Cargo;
+ANALYZE Passenger;
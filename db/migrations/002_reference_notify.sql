@@ -0,0 +1,33 @@
+-- Tell clients caching the reference tables when one of them changes
+-- shells LISTEN on reference_changed and reload their cache when it fires
+
+CREATE OR REPLACE FUNCTION notify_reference() RETURNS trigger AS $$
+BEGIN
+	PERFORM pg_notify('reference_changed', TG_TABLE_NAME);
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS locationtype_notify ON LocationType;
+CREATE TRIGGER locationtype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON LocationType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
+
+DROP TRIGGER IF EXISTS statustype_notify ON StatusType;
+CREATE TRIGGER statustype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON StatusType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
+
+DROP TRIGGER IF EXISTS terminaltype_notify ON TerminalType;
+CREATE TRIGGER terminaltype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON TerminalType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
+
+DROP TRIGGER IF EXISTS gatetype_notify ON GateType;
+CREATE TRIGGER gatetype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON GateType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
+
+DROP TRIGGER IF EXISTS airlinetype_notify ON AirlineType;
+CREATE TRIGGER airlinetype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON AirlineType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
+
+DROP TRIGGER IF EXISTS airplanetype_notify ON AirplaneType;
+CREATE TRIGGER airplanetype_notify AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON AirplaneType
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_reference();
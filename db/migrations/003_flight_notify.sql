@@ -0,0 +1,68 @@
+-- Tell clients caching flights when one of them changes
+-- shells LISTEN on flight_changed and drop the flight number in the payload
+
+CREATE OR REPLACE FUNCTION notify_flight() RETURNS trigger AS $$
+BEGIN
+	PERFORM pg_notify('flight_changed', OLD.flight_number);
+	IF TG_OP = 'UPDATE' AND NEW.flight_number <> OLD.flight_number THEN
+		PERFORM pg_notify('flight_changed', NEW.flight_number);
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- only the columns status shows, passenger_count follows Passenger rows that
+-- notify below and cargo_weight_total isn't shown, so the counter updates
+-- made for every passenger and parcel stay quiet
+DROP TRIGGER IF EXISTS flight_notify ON Flight;
+CREATE TRIGGER flight_notify AFTER UPDATE ON Flight
+	FOR EACH ROW
+	WHEN (OLD.flight_number IS DISTINCT FROM NEW.flight_number
+		OR OLD.departure_time IS DISTINCT FROM NEW.departure_time
+		OR OLD.arrival_time IS DISTINCT FROM NEW.arrival_time
+		OR OLD.gate_id IS DISTINCT FROM NEW.gate_id
+		OR OLD.status_id IS DISTINCT FROM NEW.status_id
+		OR OLD.airplane_id IS DISTINCT FROM NEW.airplane_id
+		OR OLD.airline_id IS DISTINCT FROM NEW.airline_id
+		OR OLD.origin_id IS DISTINCT FROM NEW.origin_id
+		OR OLD.destination_id IS DISTINCT FROM NEW.destination_id)
+	EXECUTE FUNCTION notify_flight();
+
+DROP TRIGGER IF EXISTS flight_delete_notify ON Flight;
+CREATE TRIGGER flight_delete_notify AFTER DELETE ON Flight
+	FOR EACH ROW EXECUTE FUNCTION notify_flight();
+
+-- passengers and cargo change many rows at a time, so these fire once per
+-- statement and notify each flight it touched once
+CREATE OR REPLACE FUNCTION notify_flight_rows() RETURNS trigger AS $$
+BEGIN
+	IF TG_OP = 'INSERT' THEN
+		PERFORM pg_notify('flight_changed', Flight.flight_number)
+		FROM Flight WHERE Flight.id IN (SELECT DISTINCT flight_id FROM changed_new);
+	ELSE
+		PERFORM pg_notify('flight_changed', Flight.flight_number)
+		FROM Flight WHERE Flight.id IN (SELECT DISTINCT flight_id FROM changed_old);
+	END IF;
+	RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS passenger_insert_notify ON Passenger;
+CREATE TRIGGER passenger_insert_notify AFTER INSERT ON Passenger
+	REFERENCING NEW TABLE AS changed_new
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_flight_rows();
+
+DROP TRIGGER IF EXISTS passenger_delete_notify ON Passenger;
+CREATE TRIGGER passenger_delete_notify AFTER DELETE ON Passenger
+	REFERENCING OLD TABLE AS changed_old
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_flight_rows();
+
+DROP TRIGGER IF EXISTS cargo_insert_notify ON Cargo;
+CREATE TRIGGER cargo_insert_notify AFTER INSERT ON Cargo
+	REFERENCING NEW TABLE AS changed_new
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_flight_rows();
+
+DROP TRIGGER IF EXISTS cargo_delete_notify ON Cargo;
+CREATE TRIGGER cargo_delete_notify AFTER DELETE ON Cargo
+	REFERENCING OLD TABLE AS changed_old
+	FOR EACH STATEMENT EXECUTE FUNCTION notify_flight_rows();
@@ -0,0 +1,21 @@
+-- Passenger count and cargo weight kept on each flight
+-- the statements that add or remove passengers and cargo adjust these in the
+-- same statement, so status and checkCargo read them instead of aggregating,
+-- and recount recomputes them if they ever drift
+
+ALTER TABLE Flight ADD COLUMN IF NOT EXISTS passenger_count INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE Flight ADD COLUMN IF NOT EXISTS cargo_weight_total NUMERIC NOT NULL DEFAULT 0;
+
+-- bring existing flights up to date, the locks keep writers out until it commits
+BEGIN;
+LOCK TABLE Passenger, Cargo IN SHARE MODE;
+UPDATE Flight
+SET passenger_count = COALESCE(passengers.total, 0),
+	cargo_weight_total = COALESCE(cargo.total, 0)
+FROM Flight AS f
+	LEFT JOIN (SELECT flight_id, count(*) AS total FROM Passenger GROUP BY flight_id) AS passengers ON (passengers.flight_id = f.id)
+	LEFT JOIN (SELECT flight_id, SUM(weight_lb) AS total FROM Cargo GROUP BY flight_id) AS cargo ON (cargo.flight_id = f.id)
+WHERE Flight.id = f.id
+	AND (Flight.passenger_count <> COALESCE(passengers.total, 0)
+		OR Flight.cargo_weight_total <> COALESCE(cargo.total, 0));
+COMMIT;
@@ -1,6 +1,12 @@
 #pragma once
 
+#include "flightcache.h"
+#include "listener.h"
+#include "pool.h"
+#include "reference.h"
+
 #include <iostream>
+#include <memory>
 #include <pqxx/pqxx>
 
 class API {
@@ -12,18 +18,36 @@ private:
     static const std::string port;
     static const std::string dbname;
     static const std::string connect_timeout;
+    static const std::size_t poolSize;
     // user and password can change
     std::string user;
     std::string password;
+    // shared between copies so every copy reuses the same connections
+    std::shared_ptr<ConnectionPool> pool;
+    // LISTEN connection behind both caches, shared the same way
+    std::shared_ptr<NotificationListener> notifications;
+    // names to ids of the reference tables
+    std::shared_ptr<ReferenceCache> types;
+    // recently looked up flights
+    std::shared_ptr<FlightCache> snapshots;
 
     std::string getConnectionString() const;
 
+    // opens its own non-blocking connections
+    friend class AsyncExecutor;
+
 public:
 
-    API(std::string, std::string);
+    API(std::string, std::string, std::size_t = poolSize);
     API(const API&);
 
-    pqxx::connection begin() const;
+    PooledConnection begin() const;
+    ReferenceCache& reference() const;
+    FlightCache& flights() const;
 
-};
+    // runs every later command inside one transaction until endTransaction,
+    // throws std::logic_error unless the API was made with one connection
+    void beginTransaction() const;
+    void endTransaction(bool) const;
 
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "api.h"
+#include "console.h"
+#include "error.h"
+#include "operation.h"
+
+#include <libpq-fe.h>
+#include <poll.h>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// read only view of a libpq result with the parts of pqxx::result the
+// staged commands' finish functions use, so one template handles both
+class AsyncResult {
+
+public:
+
+    class Field {
+        const PGresult* result;
+        int row;
+        int column;
+    public:
+        Field(const PGresult* result, int row, int column) : result(result), row(row), column(column) {}
+        bool is_null() const { return PQgetisnull(this->result, this->row, this->column); }
+        const char* c_str() const { return PQgetvalue(this->result, this->row, this->column); }
+        std::size_t size() const { return PQgetlength(this->result, this->row, this->column); }
+
+        // text format values, booleans come back as t or f
+        template<typename T> T as() const {
+            if constexpr(std::is_same_v<T, std::string>) return std::string(this->c_str(), this->size());
+            else if constexpr(std::is_same_v<T, bool>) return this->c_str()[0] == 't';
+            else if constexpr(std::is_floating_point_v<T>) return static_cast<T>(std::strtod(this->c_str(), nullptr));
+            else return static_cast<T>(std::strtoll(this->c_str(), nullptr, 10));
+        }
+    };
+
+    class Row {
+    protected:
+        const PGresult* result;
+        int index;
+    public:
+        Row(const PGresult* result, int index) : result(result), index(index) {}
+        Field operator[](int column) const { return Field(this->result, this->index, column); }
+        std::size_t size() const { return PQnfields(this->result); }
+    };
+
+    // a row that steps through the result, it[n] reads a field like pqxx's
+    class Iterator : public Row {
+    public:
+        using Row::Row;
+        Iterator& operator++() { ++this->index; return *this; }
+        bool operator==(const Iterator& other) const { return this->index == other.index; }
+        bool operator!=(const Iterator& other) const { return this->index != other.index; }
+        const Row& operator*() const { return *this; }
+    };
+
+private:
+
+    std::shared_ptr<PGresult> result;
+
+public:
+
+    explicit AsyncResult(std::shared_ptr<PGresult> result) : result(std::move(result)) {}
+
+    bool empty() const { return this->size() == 0; }
+    std::size_t size() const { return PQntuples(this->result.get()); }
+    Row operator[](std::size_t row) const { return Row(this->result.get(), static_cast<int>(row)); }
+    Iterator begin() const { return Iterator(this->result.get(), 0); }
+    Iterator end() const { return Iterator(this->result.get(), static_cast<int>(this->size())); }
+
+};
+
+// runs staged commands without blocking the calling thread on libpq's
+// non-blocking pipeline mode, so one thread keeps many commands in flight
+// over a few connections
+// it has no thread of its own, the owner polls the sockets from watch() and
+// calls process() when any of them is ready, or drain() to wait for everything
+class AsyncExecutor {
+
+public:
+
+    // the command's status and everything it printed
+    typedef std::function<void(error_t, const std::string&)> callback_t;
+
+private:
+
+    // what each result a connection will send back belongs to, in order
+    struct Pending {
+        enum Kind { prepare, query, sync } kind;
+        std::string name;
+        Staged staged;
+        unsigned long epoch = 0;
+        callback_t done;
+        std::shared_ptr<PGresult> result;
+    };
+
+    struct Channel {
+        PGconn* connection = nullptr;
+        // PQconnectPoll's last answer, PGRES_POLLING_OK once it is connected
+        PostgresPollingStatusType polling = PGRES_POLLING_FAILED;
+        std::set<std::string> prepared;
+        std::deque<Pending> inFlight;
+        // submitted while it was connecting, sent once it is up
+        std::deque<Pending> queued;
+        // output is waiting for the socket to take it
+        bool writing = false;
+    };
+
+    API api;
+    std::vector<Channel> channels;
+    std::size_t queries;
+
+    bool open(Channel&);
+    void connect(Channel&);
+    bool send(Channel&, Pending&);
+    void fail(Channel&, const std::string&);
+    void receive(Channel&);
+    void finish(Pending&);
+
+public:
+
+    AsyncExecutor(const API&, std::size_t);
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    ~AsyncExecutor();
+
+    // whether the command has an asynchronous path, see Staged::async
+    static bool accepts(const CommandSpec&);
+
+    // stages a command and sends it, done runs from process() once it has
+    // finished, or straight away if it fails validation or the cache answers it
+    void submit(const CommandSpec&, const args_t&, callback_t);
+
+    // the sockets to wait on and whether each wants to write
+    void watch(std::vector<pollfd>&) const;
+    // handles whatever the connections have sent back, never blocks
+    void process();
+    // runs until every submitted command has finished
+    void drain();
+
+    // commands sent and not yet finished
+    std::size_t pending() const;
+
+};
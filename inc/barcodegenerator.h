@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// random [a-zA-Z0-9]{12} barcodes from an engine seeded once per thread,
+// so generating one never touches std::random_device after the first
+class BarcodeGenerator {
+
+private:
+
+    static std::mt19937_64& engine();
+
+public:
+
+    static constexpr std::size_t length = 12;
+    static constexpr char alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    // writes exactly length characters to out
+    static void fill(char* out);
+
+    static std::string next();
+    static std::vector<std::string> batch(std::size_t);
+
+};
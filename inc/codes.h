@@ -0,0 +1,99 @@
+#pragma once
+
+#include "validate.h"
+
+#include <pqxx/pqxx>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// a short code of at most N characters kept inline, so it is trivially
+// copyable and never allocates, valid is the matcher from validate.h that
+// parse() checks it against
+template<std::size_t N, bool (*valid)(std::string_view)>
+class Code {
+
+private:
+
+    // unused characters stay zero so equal codes compare equal byte for byte
+    std::array<char, N> text {};
+    std::uint8_t length = 0;
+
+public:
+
+    static constexpr std::size_t capacity = N;
+
+    constexpr Code() = default;
+
+    // false and left empty unless s is a valid code
+    static constexpr bool parse(std::string_view s, Code& code) {
+        code = Code();
+        if(s.size() > N || !valid(s)) return false;
+        for(std::size_t i = 0; i < s.size(); ++i) code.text[i] = s[i];
+        code.length = static_cast<std::uint8_t>(s.size());
+        return true;
+    }
+
+    constexpr std::string_view view() const { return std::string_view(this->text.data(), this->length); }
+    std::string str() const { return std::string(this->text.data(), this->length); }
+    constexpr bool empty() const { return this->length == 0; }
+
+    // the characters packed into one word, cheap to hash and order
+    std::uint64_t key() const {
+        static_assert(N <= 8, "codes wider than a word hash their view instead");
+        std::uint64_t packed = 0;
+        std::memcpy(&packed, this->text.data(), N);
+        return packed;
+    }
+
+    constexpr bool operator==(const Code& other) const { return this->view() == other.view(); }
+    constexpr bool operator!=(const Code& other) const { return !(*this == other); }
+    constexpr bool operator<(const Code& other) const { return this->view() < other.view(); }
+    constexpr bool operator==(std::string_view other) const { return this->view() == other; }
+    constexpr bool operator!=(std::string_view other) const { return this->view() != other; }
+
+};
+
+// [A-Z]{2}[0-9]{2,4}, VARCHAR(7) in Flight
+typedef Code<6, Validate::flightNumber> FlightNumber;
+// [A-Z]{4}
+typedef Code<4, Validate::icao> ICAO;
+// [A-Z][0-9]{1,2}, letter and number of a gate
+typedef Code<3, Validate::gate> Gate;
+// [a-zA-Z0-9]{12}
+typedef Code<12, Validate::barcode> Barcode;
+
+template<std::size_t N, bool (*valid)(std::string_view)>
+std::ostream& operator<<(std::ostream& os, const Code<N, valid>& code) {
+    return os << code.view();
+}
+
+namespace std {
+    template<std::size_t N, bool (*valid)(std::string_view)>
+    struct hash<Code<N, valid>> {
+        std::size_t operator()(const Code<N, valid>& code) const {
+            if constexpr(N <= 8) return std::hash<std::uint64_t>()(code.key());
+            else return std::hash<std::string_view>()(code.view());
+        }
+    };
+}
+
+// lets a code be passed straight to exec_prepared and read back with as<>()
+namespace pqxx {
+    template<std::size_t N, bool (*valid)(std::string_view)>
+    struct string_traits<Code<N, valid>> {
+        static constexpr const char* name() noexcept { return "Code"; }
+        static constexpr bool has_null() noexcept { return false; }
+        static bool is_null(const Code<N, valid>&) { return false; }
+        [[noreturn]] static Code<N, valid> null() { internal::throw_null_conversion(name()); }
+        static void from_string(const char text[], Code<N, valid>& code) {
+            if(!Code<N, valid>::parse(text, code)) throw std::range_error(std::string("not a valid code: ") + text);
+        }
+        static std::string to_string(const Code<N, valid>& code) { return code.str(); }
+    };
+}
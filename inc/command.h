@@ -1,28 +1,43 @@
 #pragma once
 
 #include "error.h"
+#include "smallvector.h"
 
 #include <iostream>
 #include <map>
-#include <list>
 #include <iomanip>
+#include <string>
+#include <string_view>
+
+// arguments of a command, views into the line the command was parsed from
+typedef SmallVector<std::string_view, 16> args_t;
 
 class Command {
 
-    std::string command;
-    std::list<std::string> args;
+    // owns the characters every token points into
+    std::string line;
+    std::string_view command;
+    args_t args;
+
+    void tokenize();
+    void rebase(const Command&, const char*);
 
 public:
 
 // constructors
     Command();
-    Command(const std::string&, const std::list<std::string>);
+    explicit Command(std::string);
+    // the tokens are views into the line, so every copy and move points
+    // them at the line it ends up owning
     Command(const Command&);
-    
+    Command(Command&&);
+    Command& operator=(const Command&);
+    Command& operator=(Command&&);
+
 // ostream for debug
     friend std::ostream& operator<<(std::ostream&, const Command&);
 
 // get
-    std::string getCommand() const;
-    const std::list<std::string>& getArgs() const;
-};
\ No newline at end of file
+    std::string_view getCommand() const;
+    const args_t& getArgs() const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+// where commands write their output and errors, std::cout and std::cerr
+// unless the calling thread redirected them, so a server worker can send a
+// command's output to the session that ran it
+class Console {
+
+private:
+
+    static thread_local std::ostream* output;
+    static thread_local std::ostream* errors;
+
+public:
+
+    static std::ostream& out();
+    static std::ostream& err();
+
+    // sends both to the stream until it goes out of scope
+    class Redirect {
+        std::ostream* output;
+        std::ostream* errors;
+    public:
+        explicit Redirect(std::ostream&);
+        Redirect(const Redirect&) = delete;
+        ~Redirect();
+    };
+
+};
@@ -11,4 +11,7 @@ public:
     static const int BADARGS = 2;
     static const int BADCMD = 3;
     static const int DBERROR = 4;
+    static const int NOTFOUND = 5;
+    static const int INACTIVE = 6;
+    static const int FULL = 7;
 };
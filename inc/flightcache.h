@@ -0,0 +1,58 @@
+#pragma once
+
+#include "codes.h"
+#include "listener.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// the columns of get_flight for one active flight, as text
+typedef std::vector<std::string> snapshot_t;
+
+// recently looked up flights by flight number so a repeated status needs no
+// query, bounded by evicting the least recently used flight
+// entries are dropped by this process when it changes a flight and by the
+// database on flight_changed when anyone else does
+class FlightCache {
+
+private:
+
+    struct Entry {
+        snapshot_t snapshot;
+        std::list<FlightNumber>::iterator position;
+    };
+
+    std::shared_ptr<NotificationListener> listener;
+    std::mutex mutex;
+    std::unordered_map<FlightNumber, Entry> entries;
+    // most recently used first
+    std::list<FlightNumber> order;
+    // bumped on every invalidation, a snapshot read before one is not stored
+    std::atomic<unsigned long> generation;
+    std::atomic<unsigned long> hitCount;
+    std::atomic<unsigned long> missCount;
+
+public:
+
+    static const std::string channel;
+    static const std::size_t capacity;
+
+    explicit FlightCache(std::shared_ptr<NotificationListener>);
+    FlightCache(const FlightCache&) = delete;
+
+    // false on a miss, the current epoch is what store() needs afterwards
+    bool find(FlightNumber, snapshot_t&, unsigned long&);
+    void store(FlightNumber, snapshot_t, unsigned long);
+    void invalidate(FlightNumber);
+    void clear();
+
+    unsigned long epoch() const;
+    unsigned long hits() const;
+    unsigned long misses() const;
+
+};
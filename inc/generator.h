@@ -0,0 +1,82 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+// fills the airport database with synthetic flights, passengers, cargo and
+// meals at a chosen scale, streaming each table in with COPY
+class Generator {
+
+public:
+
+    // row counts to generate, passengers and cargo are totals spread over the flights
+    struct Scale {
+        std::uint64_t flights = 10000;
+        std::uint64_t passengers = 1000000;
+        std::uint64_t cargo = 200000;
+        unsigned mealsPerFlight = 3;
+        std::uint64_t seed = 1;
+    };
+
+private:
+
+    struct Airplane {
+        int id;
+        double maxCargo;
+        int maxPassengers;
+    };
+
+    // a flight as the child tables need it
+    struct Flight {
+        std::uint64_t id;
+        const Airplane* airplane;
+    };
+
+    pqxx::connection& connection;
+    Scale scale;
+    std::mt19937_64 engine;
+
+    // reference data already in the database
+    std::vector<int> gates;
+    std::vector<int> airlines;
+    std::vector<int> locations;
+    std::vector<int> meals;
+    std::vector<Airplane> airplanes;
+
+    // next free ids, generated rows carry explicit ids so the children can refer to them
+    std::uint64_t nextFlight = 0;
+    std::uint64_t nextPassenger = 0;
+    std::uint64_t nextCargo = 0;
+    std::uint64_t rows = 0;
+
+    void loadReference();
+    std::uint64_t between(std::uint64_t, std::uint64_t);
+    template<typename T> const T& pick(const std::vector<T>&);
+    std::uint64_t share(std::uint64_t, std::uint64_t);
+
+    static std::string timestamp(std::time_t);
+    static std::string barcode(std::uint64_t);
+
+    void flights(std::vector<Flight>&, std::uint64_t);
+    void children(const std::vector<Flight>&);
+
+public:
+
+    // ids used by the airport itself, every flight leaves or lands here
+    static constexpr int home = 1;
+    // status ids of finished flights
+    static constexpr int arrived = 6;
+    static constexpr int cancelled = 7;
+    // flights are generated in chunks so memory stays flat at any scale
+    static constexpr std::uint64_t chunk = 100000;
+
+    Generator(pqxx::connection&, const Scale&);
+
+    // generates everything and returns the number of rows written
+    std::uint64_t run();
+
+};
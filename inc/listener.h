@@ -0,0 +1,56 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// one LISTEN connection shared by the client side caches, notifications are
+// only picked up when a cache polls before answering from memory
+class NotificationListener {
+
+public:
+
+    typedef std::function<void(const std::string&)> handler_t;
+    typedef std::function<void()> reset_t;
+
+private:
+
+    struct Subscription {
+        std::string channel;
+        // runs with the payload of every notification on the channel
+        handler_t handler;
+        // runs whenever the connection is (re)opened, anything sent while it
+        // was down is lost so the subscriber has to assume everything changed
+        reset_t reset;
+    };
+
+    class Receiver : public pqxx::notification_receiver {
+        handler_t handler;
+    public:
+        Receiver(pqxx::connection&, const std::string&, handler_t);
+        void operator()(const std::string&, int) override;
+    };
+
+    const std::string connectionString;
+    std::mutex mutex;
+    std::unique_ptr<pqxx::connection> connection;
+    std::vector<std::unique_ptr<Receiver>> receivers;
+    std::vector<Subscription> subscriptions;
+
+    void reconnect();
+
+public:
+
+    explicit NotificationListener(const std::string&);
+    NotificationListener(const NotificationListener&) = delete;
+
+    void subscribe(const std::string&, handler_t, reset_t);
+
+    // delivers notifications that already arrived, which needs no round trip,
+    // false if the connection is down and can't be reopened
+    bool poll();
+
+};
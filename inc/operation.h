@@ -1,60 +1,90 @@
 #pragma once
 
 #include "command.h"
+#include "console.h"
 #include "error.h"
 #include "api.h"
+#include "barcodegenerator.h"
+#include "registry.h"
+#include "statement.h"
+#include "tablewriter.h"
+#include "validate.h"
 
 #include <pqxx/pqxx>
-#include <regex>
+#include <chrono>
+#include <fstream>
 #include <iomanip>
-#include <random>
 #include <string>
+#include <vector>
 
-// defines operation ids for jump table
-typedef int operation_t;
+class AsyncResult;
+
+// flight numbers given to one command
+typedef Arg::FlightNumbers::type flights_t;
+
+// one flight of a multi-flight lookup, its get_flight columns unless the
+// status is NOTFOUND
+struct FlightStatus {
+    FlightNumber flight;
+    error_t status;
+    snapshot_t snapshot;
+};
+
+// a command's statement and parameters, split from the handling of its result
+// so the statement can be queued in a pipeline and the reply handled later
+struct Staged {
+    std::string statement;
+    std::vector<std::string> params;
+    error_t (*finish)(const Staged&, const pqxx::result&);
+    // changes the flight in params[0], so its cached snapshot is dropped
+    bool writes = false;
+    // the same handling for a reply read without pqxx, set by the commands
+    // AsyncExecutor can run
+    error_t (*async)(const Staged&, const AsyncResult&) = nullptr;
+};
 
 class Operation {
 public:
 
-    // operation ids
-    static constexpr operation_t c_exit = 0;
-    static constexpr operation_t c_help = 1;
-    static constexpr operation_t c_status = 2;
-    static constexpr operation_t c_create = 3;
-    static constexpr operation_t c_depart = 4;
-    static constexpr operation_t c_arrive = 5;
-    static constexpr operation_t c_passengers = 6;
-    static constexpr operation_t c_list = 7;
-    static constexpr operation_t c_delay = 8;
-    static constexpr operation_t c_meals = 9;
-    static constexpr operation_t c_mealTypes = 10;
-    static constexpr operation_t c_changeStatus = 11;
-    static constexpr operation_t c_changeDestination = 12;
-    static constexpr operation_t c_removeCargo = 13;
-    static constexpr operation_t c_addCargo = 14;
-    static constexpr operation_t c_changeOrigin = 15;
-    static constexpr operation_t c_checkCargo = 16;
-
-    // operation functions
-    static error_t shell_exit();
-    static error_t help();
-    static error_t status(const API&, const std::list<std::string>&);
-    static error_t create(const API&, const std::list<std::string>&);
-    static error_t depart(const API&, const std::list<std::string>&);
-    static error_t arrive(const API&, const std::list<std::string>&);
-    static error_t passengers(const API&, const std::list<std::string>&);
-    static error_t addCargo(const API&, const std::list<std::string>&);
-    static error_t removeCargo(const API&, const std::list<std::string>&);
-    static error_t checkCargo(const API &, const std::list<std::string> &);
-    static error_t list(const API&);
-    static error_t delay(const API&, const std::list<std::string>&);
-    static error_t mealTypes(const API&, const std::list<std::string>&);
-    static error_t meals(const API&, const std::list<std::string>&);
-    static error_t changeStatus(const API&, const std::list<std::string>&);
-    static error_t changeDestination(const API&, const std::list<std::string>&);
-    static error_t changeOrigin(const API &, const std::list<std::string> &);
-
-    // mappings
-    static const std::map<std::string, operation_t> commandList;
-    static const std::map<std::string, std::string> commandHelp;
+    // operation functions, each takes its arguments already parsed by the
+    // schema it is registered with
+    static error_t shell_exit(const API&);
+    static error_t help(const API&);
+    static error_t stats(const API&);
+    static error_t status(const API&, const flights_t&);
+    static error_t create(const API&, FlightNumber, std::string_view, std::string_view, Gate,
+                          std::string_view, ICAO, ICAO, std::string_view);
+    static error_t depart(const API&, ICAO);
+    static error_t arrive(const API&, ICAO);
+    static error_t passengers(const API&, FlightNumber, int);
+    static error_t addCargo(const API&, FlightNumber, std::string_view, Barcode);
+    static error_t removeCargo(const API&, FlightNumber, Barcode);
+    static error_t checkCargo(const API&, FlightNumber);
+    static error_t loadCargo(const API&, FlightNumber, std::string_view);
+    static error_t list(const API&, const Arg::Page::type&);
+    static error_t delay(const API&, FlightNumber, std::string_view);
+    static error_t mealTypes(const API&, FlightNumber);
+    static error_t meals(const API&, FlightNumber);
+    static error_t changeStatus(const API&, FlightNumber, std::string_view);
+    static error_t changeDestination(const API&, FlightNumber, ICAO);
+    static error_t changeOrigin(const API&, FlightNumber, ICAO);
+    static error_t recount(const API&, bool);
+
+    // staged commands, execute() runs one on its own
+    static error_t execute(const API&, const Staged&);
+    // handles a staged command's committed result, keeping the flight cache
+    // in step, the epoch is the cache's from before the statement ran
+    static error_t finish(const API&, const Staged&, const pqxx::result&, unsigned long);
+    static error_t finish(const API&, const Staged&, const AsyncResult&, unsigned long);
+    // prints a staged command's reply from the flight cache, false on a miss
+    static bool answer(const API&, const Staged&);
+    // every flight's status in the order asked for, the cached ones from the
+    // flight cache and the rest with one get_flights query, DBERROR if that fails
+    static error_t lookup(const API&, const flights_t&, std::vector<FlightStatus>&);
+
+    // rows list fetches from its cursor per round trip
+    static constexpr long listBatch = 256;
+
+    // the registered command with this name, null when there is none
+    static const CommandSpec* find(std::string_view);
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "api.h"
+#include "command.h"
+#include "error.h"
+#include "operation.h"
+
+#include <pqxx/pqxx>
+#include <vector>
+
+// queues commands that can be staged and sends their statements together
+// through a pqxx::pipeline, so a window of N commands costs about one round
+// trip instead of N
+class Pipeline {
+
+private:
+
+    const API& api;
+    std::vector<Command> commands;
+
+    // runs the window one command at a time, used when it failed as a whole
+    std::vector<error_t> replay(const std::vector<Staged>&, std::vector<error_t>&);
+
+public:
+
+    // commands sent per round trip
+    static const std::size_t window;
+
+    explicit Pipeline(const API&);
+
+    static bool accepts(const Command&);
+    void push(const Command&);
+    std::size_t size() const;
+    const std::vector<Command>& queued() const;
+
+    // executes every queued command in order and returns their statuses
+    std::vector<error_t> flush();
+
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "stats.h"
+
+#include <pqxx/pqxx>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+class ConnectionPool;
+
+// a live connection and the bookkeeping the pool keeps alongside it
+struct PoolSlot {
+    std::unique_ptr<pqxx::connection> connection;
+    std::chrono::steady_clock::time_point lastUsed;
+    // statements already prepared on this connection
+    std::set<std::string> prepared;
+    // open while a batch runs every command in one transaction
+    std::unique_ptr<pqxx::work> outer;
+};
+
+// handle to a checked out connection, goes back to the pool when destroyed
+class PooledConnection {
+
+private:
+
+    std::shared_ptr<ConnectionPool> pool;
+    std::unique_ptr<PoolSlot> slot;
+
+public:
+
+    PooledConnection(std::shared_ptr<ConnectionPool>, std::unique_ptr<PoolSlot>);
+    PooledConnection(PooledConnection&&);
+    PooledConnection(const PooledConnection&) = delete;
+    ~PooledConnection();
+
+    pqxx::connection& operator*() const;
+    pqxx::connection* operator->() const;
+    std::set<std::string>& preparedNames();
+
+    // transaction for one command, a savepoint when a batch transaction is open
+    std::unique_ptr<pqxx::dbtransaction> transaction();
+    // starts or finishes the transaction shared by every later command
+    void beginOuter();
+    void endOuter(bool);
+
+};
+
+// bounded set of long lived connections shared by every copy of an API
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool> {
+
+private:
+
+    // idle connections older than this are pinged before being handed out
+    static const std::chrono::seconds healthInterval;
+    // how long acquire() waits for a connection when the pool is exhausted
+    static const std::chrono::seconds waitTimeout;
+
+    const std::string connectionString;
+    const std::size_t capacity;
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::vector<std::unique_ptr<PoolSlot>> idle;
+    std::size_t open; // idle + checked out
+
+    std::unique_ptr<PoolSlot> connect() const;
+    bool isHealthy(const PoolSlot&) const;
+    void release(std::unique_ptr<PoolSlot>);
+    void discard();
+
+    friend class PooledConnection;
+
+public:
+
+    ConnectionPool(const std::string&, std::size_t);
+    ConnectionPool(const ConnectionPool&) = delete;
+
+    PooledConnection acquire();
+    // most connections it will open at once
+    std::size_t size() const;
+
+};
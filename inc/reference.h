@@ -0,0 +1,74 @@
+#pragma once
+
+#include "listener.h"
+#include "pool.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// limits of an airplane type
+struct Airplane {
+    int id;
+    double maxCargo;
+    int maxPassengers;
+};
+
+// client side copy of the *Type tables so names resolve to ids without a
+// query, loaded on first use and reloaded when the database announces a change
+// on reference_changed or it is invalidated
+class ReferenceCache {
+
+private:
+
+    std::shared_ptr<ConnectionPool> pool;
+    std::shared_ptr<NotificationListener> listener;
+    std::mutex mutex;
+    // set from the listener, which never takes the mutex
+    std::atomic<bool> stale;
+    bool loaded;
+    // the loaded statuses have the ids below
+    bool matched;
+
+    std::map<std::string, int, std::less<>> locations;
+    std::map<std::string, int, std::less<>> statuses;
+    // keyed by terminal letter and gate number, like A3
+    std::map<std::string, int, std::less<>> gates;
+    std::map<std::string, int, std::less<>> airlines;
+    std::map<std::string, Airplane, std::less<>> airplanes;
+
+    void load();
+    // must hold the mutex
+    void refresh();
+    bool find(const std::map<std::string, int, std::less<>>&, std::string_view, int&);
+
+public:
+
+    static const std::string channel;
+    // the airport every flight leaves from or arrives at
+    static const std::string home;
+    // status ids list, depart, arrive and the partial indexes in
+    // db/migrations/001_indexes.sql write out instead of looking up
+    static constexpr int arrived = 6;
+    static constexpr int cancelled = 7;
+
+    ReferenceCache(std::shared_ptr<ConnectionPool>, std::shared_ptr<NotificationListener>);
+    ReferenceCache(const ReferenceCache&) = delete;
+
+    // each returns false when the name is unknown
+    bool location(std::string_view, int&);
+    bool status(std::string_view, int&);
+    bool gate(std::string_view, int&);
+    bool airline(std::string_view, int&);
+    bool airplane(std::string_view, Airplane&);
+
+    // loads the tables now rather than on the first lookup, false when
+    // StatusType doesn't give Arrived and Cancelled the ids above
+    bool warm();
+    // forces a reload on the next lookup
+    void invalidate();
+
+};
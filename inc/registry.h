@@ -0,0 +1,274 @@
+#pragma once
+
+#include "api.h"
+#include "codes.h"
+#include "command.h"
+#include "console.h"
+#include "error.h"
+#include "validate.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+struct Staged;
+
+// argument kinds a command can declare, each parses tokens from pos into its
+// type and prints why when it can't
+namespace Arg {
+
+    // one token checked by a validator and kept as a view into the line
+    template<bool (*valid)(std::string_view), const char* const* names>
+    struct Token {
+        typedef std::string_view type;
+        static constexpr std::string_view usage = names[0];
+        static bool parse(const args_t& args, std::size_t& pos, type& value) {
+            if(pos >= args.size()) {Console::err() << "missing " << names[0] << std::endl; return false;}
+            value = args[pos++];
+            if(!valid(value)) {Console::err() << names[1] << ": " << value << std::endl; return false;}
+            return true;
+        }
+    };
+
+    // one token parsed into a fixed width code from codes.h
+    template<typename T, const char* const* names>
+    struct Value {
+        typedef T type;
+        static constexpr std::string_view usage = names[0];
+        static bool parse(const args_t& args, std::size_t& pos, type& value) {
+            if(pos >= args.size()) {Console::err() << "missing " << names[0] << std::endl; return false;}
+            std::string_view token = args[pos++];
+            if(!T::parse(token, value)) {Console::err() << names[1] << ": " << token << std::endl; return false;}
+            return true;
+        }
+    };
+
+    constexpr bool any(std::string_view s) { return !s.empty(); }
+
+    // usage and error message of each token kind
+    inline constexpr const char* flightNumber[] = {"<flight-number>", "invalid flight number"};
+    inline constexpr const char* icao[] = {"<icao>", "not a valid location"};
+    inline constexpr const char* timestamp[] = {"<\"YYYY-MM-DD HH:MM:SS\">", "invalid date and time"};
+    inline constexpr const char* duration[] = {"<\"hh:mm:ss\">", "invalid duration"};
+    inline constexpr const char* gate[] = {"<gate>", "invalid gate"};
+    inline constexpr const char* airplane[] = {"<airplane>", "invalid airplane type"};
+    inline constexpr const char* airline[] = {"<airline>", "invalid airline"};
+    inline constexpr const char* status[] = {"<status>", "invalid status"};
+    inline constexpr const char* weight[] = {"<cargo-weight>", "invalid cargo weight"};
+    inline constexpr const char* barcode[] = {"<cargo-barcode>", "invalid barcode"};
+    inline constexpr const char* path[] = {"<file>", "invalid file"};
+
+    typedef Value<::FlightNumber, flightNumber> FlightNumber;
+    typedef Value<::ICAO, icao> ICAO;
+    typedef Token<Validate::dateTime, timestamp> Timestamp;
+    typedef Token<Validate::time, duration> Duration;
+    typedef Value<::Gate, gate> Gate;
+    typedef Token<Validate::airplane, airplane> Airplane;
+    typedef Token<Validate::airline, airline> Airline;
+    typedef Token<Validate::status, status> Status;
+    typedef Token<Validate::weight, weight> Weight;
+    typedef Value<::Barcode, barcode> Barcode;
+    typedef Token<any, path> Path;
+
+    // every remaining token as an A, at least one, inline up to N of them
+    template<typename A, const char* const* names, std::size_t N = 16>
+    struct Many {
+        typedef SmallVector<typename A::type, N> type;
+        static constexpr std::string_view usage = names[0];
+        static bool parse(const args_t& args, std::size_t& pos, type& values) {
+            if(pos >= args.size()) {Console::err() << "missing " << A::usage << std::endl; return false;}
+            while(pos < args.size()) {
+                typename A::type value;
+                if(!A::parse(args, pos, value)) return false;
+                values.push_back(value);
+            }
+            return true;
+        }
+    };
+
+    inline constexpr const char* flightNumbers[] = {"<flight-number>..."};
+    typedef Many<FlightNumber, flightNumbers> FlightNumbers;
+
+    // +n or -n, a bare n counts as +n
+    struct Change {
+        typedef int type;
+        static constexpr std::string_view usage = "[+/-n]";
+        static bool parse(const args_t& args, std::size_t& pos, type& value) {
+            value = 1;
+            if(pos >= args.size()) return true;
+            std::string_view change = args[pos++];
+            int sign = !change.empty() && change.front() == '-' ? -1 : 1;
+            if(!change.empty() && (change.front() == '+' || change.front() == '-')) change.remove_prefix(1);
+            bool digits = !change.empty() && change.size() <= 4;
+            value = 0;
+            for(char c : change) {
+                digits = digits && c >= '0' && c <= '9';
+                value = value * 10 + (c - '0');
+            }
+            if(!digits || value == 0) {Console::err() << "invalid passenger count" << std::endl; return false;}
+            value *= sign;
+            return true;
+        }
+    };
+
+    // true when the rest of the line is the flag, nothing else is allowed after it
+    template<const char* name, const char* const* names>
+    struct Flag {
+        typedef bool type;
+        static constexpr std::string_view usage = names[0];
+        static bool parse(const args_t& args, std::size_t& pos, type& value) {
+            value = false;
+            for(; pos < args.size(); ++pos) {
+                if(args[pos] != name) {Console::err() << "invalid option " << args[pos] << std::endl; return false;}
+                value = true;
+            }
+            return true;
+        }
+    };
+
+    inline constexpr char repairName[] = "--repair";
+    inline constexpr const char* repair[] = {"[--repair]"};
+    typedef Flag<repairName, repair> Repair;
+
+    // list's --limit, --offset, --since and --after, in any order
+    struct Page {
+        struct type {
+            std::string_view since = "-infinity";
+            // flight id within since's departure time to continue after
+            std::string_view after = "0";
+            std::string_view limit = "0";
+            std::string_view offset = "0";
+        };
+        static constexpr std::string_view usage = "[--limit n] [--offset n] [--since <\"YYYY-MM-DD HH:MM:SS\"> [--after id]]";
+        static bool parse(const args_t& args, std::size_t& pos, type& value) {
+            for(; pos < args.size(); pos += 2) {
+                if(pos + 1 >= args.size()) {Console::err() << "missing value for " << args[pos] << std::endl; return false;}
+                std::string_view option = args[pos];
+                std::string_view given = args[pos + 1];
+                bool number = !given.empty() && given.size() < 10;
+                for(char c : given) number = number && c >= '0' && c <= '9';
+                if(option == "--limit" && number) value.limit = given;
+                else if(option == "--offset" && number) value.offset = given;
+                else if(option == "--after" && number) value.after = given;
+                else if(option == "--since" && Validate::dateTime(given)) value.since = given;
+                else {Console::err() << "invalid option " << option << ' ' << given << std::endl; return false;}
+            }
+            return true;
+        }
+    };
+}
+
+// everything the shell needs to know about one command
+struct CommandSpec {
+    std::string_view name;
+    std::string_view description;
+    std::string (*usage)();
+    // parses the arguments and runs the command
+    error_t (*run)(const API&, const args_t&);
+    // parses the arguments into a statement for a pipeline, null when the
+    // command can't be split that way
+    error_t (*stage)(const args_t&, Staged&);
+    // its staged reply can be read without pqxx, so AsyncExecutor can run it
+    bool async;
+    // opens a file named in its arguments, so the server won't run it
+    bool files;
+};
+
+// a command's arguments, declared once, parsed and validated into a tuple of
+// their types before the handler sees them
+template<typename... A>
+class Schema {
+
+public:
+
+    typedef std::tuple<typename A::type...> values_t;
+
+    static constexpr bool files = (std::is_same_v<A, Arg::Path> || ...);
+
+    // arguments past the declared ones are ignored
+    static bool parse(const args_t& args, values_t& values) {
+        std::size_t pos = 0;
+        return std::apply([&](auto&... value) { return (A::parse(args, pos, value) && ...); }, values);
+    }
+
+    static std::string usage() {
+        std::string out;
+        ((out += ' ', out += A::usage), ...);
+        return out;
+    }
+
+    template<auto handler>
+    static error_t run(const API& api, const args_t& args) {
+        values_t values;
+        if(!Schema::parse(args, values)) return Error::BADARGS;
+        return std::apply([&](const auto&... value) { return handler(api, value...); }, values);
+    }
+
+    template<auto stager>
+    static error_t stage(const args_t& args, Staged& staged) {
+        values_t values;
+        if(!Schema::parse(args, values)) return Error::BADARGS;
+        staged = std::apply(stager, values);
+        return Error::SUCCESS;
+    }
+
+    // a command whose handler takes the API and then each argument's value
+    template<auto handler>
+    static constexpr CommandSpec command(std::string_view name, std::string_view description) {
+        return {name, description, Schema::usage, Schema::run<handler>, nullptr, false, Schema::files};
+    }
+
+    // the same with a stager that turns the argument values into a Staged
+    template<auto handler, auto stager>
+    static constexpr CommandSpec staged(std::string_view name, std::string_view description, bool async = false) {
+        return {name, description, Schema::usage, Schema::run<handler>, Schema::stage<stager>, async, Schema::files};
+    }
+};
+
+// maps every command name to its own slot with no collisions, the seed is
+// searched for at compile time so a lookup is one hash and one compare
+template<std::size_t N, std::size_t slots = 64>
+class PerfectHash {
+
+private:
+
+    static_assert(N < slots && (slots & (slots - 1)) == 0, "slots has to be a power of two above the command count");
+
+    std::uint32_t seed = 0;
+    // index of the command in each slot plus one, zero for an empty slot
+    std::array<std::uint8_t, slots> table {};
+
+    // FNV-1a started from the seed
+    static constexpr std::uint32_t hash(std::string_view s, std::uint32_t seed) {
+        std::uint32_t h = 2166136261u ^ seed;
+        for(char c : s) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        return h ^ (h >> 15);
+    }
+
+public:
+
+    constexpr PerfectHash(const CommandSpec (&commands)[N]) {
+        for(this->seed = 1; this->seed < 1u << 16; ++this->seed) {
+            this->table = {};
+            bool collided = false;
+            for(std::size_t i = 0; i < N && !collided; ++i) {
+                std::uint8_t& slot = this->table[hash(commands[i].name, this->seed) & (slots - 1)];
+                collided = slot != 0;
+                slot = static_cast<std::uint8_t>(i + 1);
+            }
+            if(!collided) return;
+        }
+        this->seed = 0;
+    }
+
+    constexpr bool found() const { return this->seed != 0; }
+
+    constexpr const CommandSpec* find(const CommandSpec (&commands)[N], std::string_view name) const {
+        std::uint8_t slot = this->table[hash(name, this->seed) & (slots - 1)];
+        if(slot == 0 || commands[slot - 1].name != name) return nullptr;
+        return &commands[slot - 1];
+    }
+};
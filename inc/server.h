@@ -0,0 +1,115 @@
+#pragma once
+
+#include "api.h"
+#include "async.h"
+#include "command.h"
+#include "console.h"
+#include "error.h"
+#include "shell.h"
+#include "stats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// serves the shell's command language to many clients at once over a unix
+// socket or a local tcp port, one line per command and each reply ending in
+// a status line like a batch shell's report
+// one thread reads every session, commands run on a fixed set of workers and
+// each session's commands run one at a time in the order they were sent
+// when a session's next command has an asynchronous path the reading thread
+// sends it itself through an AsyncExecutor instead of tying up a worker
+// sockets never block, a reply the client isn't reading yet waits in its
+// session until poll says the socket can take it
+class Server {
+
+private:
+
+    struct Session {
+        int socket;
+        // bytes received after the last complete line
+        std::string partial;
+        std::deque<std::string> lines;
+        // a worker is running one of its lines
+        bool busy = false;
+        // the client hung up, whatever is still queued is dropped
+        bool closed = false;
+        unsigned long lineNumber = 0;
+        // set by login, shared with every session of the same user
+        std::shared_ptr<API> api;
+
+        // guards output and hangup, replies come from workers and the reading thread
+        std::mutex writing;
+        // replies the socket hasn't taken yet
+        std::string output;
+        // shut the socket once output is sent
+        bool hangup = false;
+
+        explicit Session(int);
+        Session(const Session&) = delete;
+        ~Session();
+    };
+
+    // longest line a client may send before it is disconnected
+    static const std::size_t maxLine;
+    // most unsent output a client may leave behind before it is disconnected
+    static const std::size_t maxOutput;
+    static std::atomic<bool> stopping;
+
+    const std::string address;
+    const std::size_t workerCount;
+    // connections per user for asynchronous commands, none turns them off
+    const std::size_t asyncConnections;
+    int listener;
+    // a byte written here wakes the reading thread to watch new output
+    int wakeRead;
+    int wakeWrite;
+
+    // only touched by the reading thread
+    std::map<const API*, std::unique_ptr<AsyncExecutor>> executors;
+
+    // sessions with lines waiting and no worker on them
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<Session>> runnable;
+    // sessions whose last command finished with more lines queued, the loop
+    // schedules each next line so it can take the asynchronous path
+    std::vector<std::shared_ptr<Session>> resumed;
+
+    // one API per user and password, its pool holds a connection per worker
+    std::mutex logins;
+    std::map<std::string, std::shared_ptr<API>> apis;
+
+    bool listen();
+    void accept(std::map<int, std::shared_ptr<Session>>&);
+    bool receive(const std::shared_ptr<Session>&);
+    void schedule(const std::shared_ptr<Session>&);
+    void submit(const std::shared_ptr<Session>&, const std::string&);
+    AsyncExecutor& executor(const std::shared_ptr<API>&);
+    void work();
+    void handle(Session&, const std::string&);
+    void respond(Session&, std::string, unsigned long, std::string_view, error_t, double);
+    std::shared_ptr<API> login(const std::string&, const std::string&, std::string&);
+    void send(Session&, std::string_view, bool = false);
+    static bool flush(Session&);
+    void wake();
+
+public:
+
+    // address is a port number or the path of a unix socket
+    Server(std::string, std::size_t, std::size_t = 2);
+    Server(const Server&) = delete;
+    ~Server();
+
+    // serves until stop() is called, false if the address couldn't be bound
+    bool run();
+    // safe to call from a signal handler
+    static void stop();
+
+};
@@ -4,9 +4,12 @@
 #include "error.h"
 #include "operation.h"
 #include "api.h"
+#include "pipeline.h"
+#include "stats.h"
 
+#include <chrono>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
 
 class Shell {
 
@@ -14,16 +17,32 @@ private:
 
     bool running;
     API api;
+    // where commands come from, std::cin unless a script was given
+    std::istream& input;
+    // interactive shells prompt and log in, batch shells report on every command
+    bool interactive;
+    bool transaction;
+    // batch shells can send runs of stageable commands together
+    bool pipelined;
+    unsigned long lineNumber;
+    unsigned long failures;
 
     Command fetchCommand();
     error_t executeCommand(const Command&);
     API login();
+    void report(const Command&, error_t, double);
+    void flush(Pipeline&);
 
 public:
 
     Shell();
-    void start();
+    Shell(const API&, std::istream&, bool, bool = false);
+    int start();
 
     const API& getAPI();
 
+    static const char* describe(error_t);
+    // runs one command against the api, shared with the server's workers
+    static error_t dispatch(const API&, const Command&);
+
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// vector that keeps its first N elements inline and only touches the heap
+// once it grows past them
+template<typename T, std::size_t N>
+class SmallVector {
+
+private:
+
+    std::array<T, N> local;
+    std::vector<T> heap;
+    std::size_t count = 0;
+
+    bool spilled() const { return !this->heap.empty(); }
+
+public:
+
+    void push_back(const T& value) {
+        if(!this->spilled() && this->count < N) {
+            this->local[this->count++] = value;
+            return;
+        }
+        if(!this->spilled()) {
+            this->heap.reserve(2 * N);
+            this->heap.assign(this->local.begin(), this->local.end());
+        }
+        this->heap.push_back(value);
+        ++this->count;
+    }
+
+    void clear() {
+        this->heap.clear();
+        this->count = 0;
+    }
+
+    std::size_t size() const { return this->count; }
+    bool empty() const { return this->count == 0; }
+
+    T* begin() { return this->spilled() ? this->heap.data() : this->local.data(); }
+    T* end() { return this->begin() + this->count; }
+    const T* begin() const { return this->spilled() ? this->heap.data() : this->local.data(); }
+    const T* end() const { return this->begin() + this->count; }
+
+    T& operator[](std::size_t i) { return this->begin()[i]; }
+    const T& operator[](std::size_t i) const { return this->begin()[i]; }
+    const T& front() const { return *this->begin(); }
+    const T& back() const { return *(this->end() - 1); }
+
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "pool.h"
+#include "stats.h"
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+// registry of every named statement used by Operation, prepared lazily
+// once per pooled connection and reused on every later command
+class Statement {
+
+private:
+
+    static std::atomic<unsigned long> prepared;
+    static std::atomic<unsigned long> executed;
+
+public:
+
+    // maps statement name to its sql
+    static const std::map<std::string, std::string> sql;
+
+    // prepares the statement on the connection unless it already was
+    static void prepare(PooledConnection&, const std::string&);
+
+    template<typename... Args>
+    static pqxx::result exec(pqxx::transaction_base& query, PooledConnection& connection, const std::string& name, Args&&... args) {
+        prepare(connection, name);
+        ++executed;
+        Stats::Timer timer(Stats::execute);
+        pqxx::result result = query.exec_prepared(name, std::forward<Args>(args)...);
+        Stats::roundTrip(result.size());
+        return result;
+    }
+
+    // runs a statement whose parameters were collected at runtime
+    static pqxx::result execParams(pqxx::transaction_base&, PooledConnection&, const std::string&, const std::vector<std::string>&);
+
+    // statement text with each $n replaced by its quoted parameter, for
+    // sending through a pqxx::pipeline which only takes plain queries
+    static std::string expand(const pqxx::transaction_base&, const std::string&, const std::vector<std::string>&);
+
+    // commits a command's transaction, timed as part of executing it
+    static void commit(pqxx::transaction_base&);
+
+    // counters
+    static unsigned long prepareCount();
+    static unsigned long executeCount();
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// per command instrumentation, splits each command's wall time into the time
+// spent getting a connection, preparing and executing statements, and the
+// rest, which is argument handling and formatting the output
+class Stats {
+
+public:
+
+    // phases timed separately
+    static constexpr int connect = 0;
+    static constexpr int prepare = 1;
+    static constexpr int execute = 2;
+    static constexpr int phases = 3;
+
+    // histogram bucket i counts commands that took under 2^i microseconds
+    static constexpr std::size_t buckets = 28;
+
+    struct Record {
+        unsigned long count = 0;
+        double wall = 0;
+        std::array<double, phases> phase {};
+        unsigned long roundTrips = 0;
+        unsigned long rows = 0;
+        std::array<unsigned long, buckets> histogram {};
+    };
+
+    // adds its own lifetime to a phase of the command running on this thread
+    class Timer {
+        int phase;
+        std::chrono::steady_clock::time_point start;
+    public:
+        explicit Timer(int phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+        ~Timer() {
+            std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+            Stats::add(phase, took.count());
+        }
+    };
+
+private:
+
+    static std::mutex mutex;
+    static std::map<std::string, Record, std::less<>> records;
+    // the command in progress on this thread
+    static thread_local Record current;
+
+public:
+
+    // brackets one command
+    static void begin();
+    static void end(std::string_view, double);
+
+    static void add(int, double);
+    static void roundTrip(std::size_t);
+
+    static void print(std::ostream&);
+    // writes every command's histogram as csv, false if the file can't be written
+    static bool dump(const std::string&);
+
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// formats rows into one reused buffer and hands it to the stream in a single
+// write per batch, as an aligned text table, csv or one json object per line
+class TableWriter {
+
+public:
+
+    // output formats
+    static constexpr int text = 0;
+    static constexpr int csv = 1;
+    static constexpr int jsonl = 2;
+
+    // format used by the shell commands, set once at startup
+    static int format;
+
+    struct Column {
+        // heading in text tables
+        std::string label;
+        // csv header and json key
+        std::string key;
+        // right aligned to this width in text tables
+        std::size_t width;
+    };
+
+    // buffered bytes that trigger a write
+    static constexpr std::size_t batch = 1 << 16;
+
+private:
+
+    std::ostream& out;
+    std::vector<Column> columns;
+    int mode;
+    std::string buffer;
+    std::size_t column = 0;
+
+    void separator();
+    void quoted(std::string_view);
+
+public:
+
+    TableWriter(std::ostream&, std::vector<Column>, int = TableWriter::format);
+    TableWriter(const TableWriter&) = delete;
+    ~TableWriter();
+
+    // column headings for text and csv, nothing for json lines
+    void header();
+
+    // fields are given left to right, endRow after the last one
+    TableWriter& field(std::string_view);
+    // a number as the database prints it, bare in csv and json lines
+    TableWriter& number(std::string_view);
+    TableWriter& null();
+    void endRow();
+
+    // writes whatever is buffered
+    void flush();
+
+    static bool parseFormat(std::string_view, int&);
+
+};
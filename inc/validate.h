@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// set of characters built at compile time from a range list like "a-zA-Z0-9 "
+class CharClass {
+
+private:
+
+    bool table[256] {};
+
+public:
+
+    constexpr CharClass(const char* ranges) {
+        for(std::size_t i = 0; ranges[i] != '\0'; ++i) {
+            unsigned char from = static_cast<unsigned char>(ranges[i]);
+            unsigned char to = from;
+            if(ranges[i + 1] == '-' && ranges[i + 2] != '\0') {
+                to = static_cast<unsigned char>(ranges[i + 2]);
+                i += 2;
+            }
+            for(unsigned c = from; c <= to; ++c) table[c] = true;
+        }
+    }
+
+    constexpr bool operator()(char c) const {
+        return table[static_cast<unsigned char>(c)];
+    }
+
+};
+
+// argument validation for the fixed formats used by the shell commands,
+// hand written matchers equivalent to the regex noted on each function
+class Validate {
+
+private:
+
+    static constexpr CharClass digit{"0-9"};
+    static constexpr CharClass upper{"A-Z"};
+    static constexpr CharClass alnum{"a-zA-Z0-9"};
+    static constexpr CharClass airplaneChars{"a-zA-Z0-9 "};
+    static constexpr CharClass airlineChars{"a-zA-Z "};
+
+    // consumes between min and max characters of cls starting at pos
+    static constexpr bool run(std::string_view s, std::size_t& pos, const CharClass& cls, std::size_t min, std::size_t max) {
+        std::size_t count = 0;
+        while(pos < s.size() && count < max && cls(s[pos])) { ++pos; ++count; }
+        return count >= min;
+    }
+
+    static constexpr bool literal(std::string_view s, std::size_t& pos, char c) {
+        if(pos >= s.size() || s[pos] != c) return false;
+        ++pos;
+        return true;
+    }
+
+    // every character belongs to cls and there is at least one
+    static constexpr bool only(std::string_view s, const CharClass& cls) {
+        std::size_t pos = 0;
+        return run(s, pos, cls, 1, s.size()) && pos == s.size();
+    }
+
+    // two digit field between 0 and max
+    static constexpr bool upTo(std::string_view s, std::size_t pos, int max) {
+        return digit(s[pos]) && digit(s[pos + 1]) && (s[pos] - '0') * 10 + (s[pos + 1] - '0') <= max;
+    }
+
+public:
+
+    // [a-zA-Z0-9]{12}
+    static constexpr bool barcode(std::string_view s) {
+        return s.size() == 12 && only(s, alnum);
+    }
+
+    // [A-Z]{2}[0-9]{2,4}
+    static constexpr bool flightNumber(std::string_view s) {
+        std::size_t pos = 0;
+        return run(s, pos, upper, 2, 2) && run(s, pos, digit, 2, 4) && pos == s.size();
+    }
+
+    // [0-9]{4}-[0-9]{2}-[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2}
+    static constexpr bool dateTime(std::string_view s) {
+        std::size_t pos = 0;
+        return run(s, pos, digit, 4, 4) && literal(s, pos, '-')
+            && run(s, pos, digit, 2, 2) && literal(s, pos, '-')
+            && run(s, pos, digit, 2, 2) && literal(s, pos, ' ')
+            && run(s, pos, digit, 2, 2) && literal(s, pos, ':')
+            && run(s, pos, digit, 2, 2) && literal(s, pos, ':')
+            && run(s, pos, digit, 2, 2) && pos == s.size();
+    }
+
+    // (?:[01][0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9](?:\.[0-9]{1,3})?
+    static constexpr bool time(std::string_view s) {
+        if(s.size() < 8 || s[2] != ':' || s[5] != ':') return false;
+        if(!upTo(s, 0, 23) || !upTo(s, 3, 59) || !upTo(s, 6, 59)) return false;
+        if(s.size() == 8) return true;
+        std::size_t pos = 8;
+        return literal(s, pos, '.') && run(s, pos, digit, 1, 3) && pos == s.size();
+    }
+
+    // [A-Z]{4}
+    static constexpr bool icao(std::string_view s) {
+        return s.size() == 4 && only(s, upper);
+    }
+
+    // [A-Z][0-9]{1,2}
+    static constexpr bool gate(std::string_view s) {
+        std::size_t pos = 0;
+        return run(s, pos, upper, 1, 1) && run(s, pos, digit, 1, 2) && pos == s.size();
+    }
+
+    // [a-zA-Z0-9 ]+
+    static constexpr bool airplane(std::string_view s) {
+        return only(s, airplaneChars);
+    }
+
+    // [a-zA-Z ]+
+    static constexpr bool airline(std::string_view s) {
+        return only(s, airlineChars);
+    }
+
+    // [0-9]+(\.[0-9]+)?
+    static constexpr bool weight(std::string_view s) {
+        std::size_t pos = 0;
+        if(!run(s, pos, digit, 1, s.size())) return false;
+        if(pos == s.size()) return true;
+        return literal(s, pos, '.') && run(s, pos, digit, 1, s.size()) && pos == s.size();
+    }
+
+    // (Standby|Boarding|Departed|Delayed|In Transit|Arrived|Cancelled)
+    static constexpr bool status(std::string_view s) {
+        constexpr std::string_view names[] = {
+            "Standby", "Boarding", "Departed", "Delayed", "In Transit", "Arrived", "Cancelled"
+        };
+        for(auto name : names) {
+            if(s == name) return true;
+        }
+        return false;
+    }
+
+};
@@ -1,16 +1,24 @@
 #include "../inc/api.h"
 
+#include <stdexcept>
+
 // default connections
 const std::string API::host = "localhost";
 const std::string API::port = "5432";
 const std::string API::dbname = "airport";
 const std::string API::connect_timeout = "1";
+const std::size_t API::poolSize = 4;
 
-API::API(std::string user, std::string password) 
-: user(user), password(password) {}
+API::API(std::string user, std::string password, std::size_t connections) 
+: user(user), password(password), 
+  pool(std::make_shared<ConnectionPool>(this->getConnectionString(), connections)),
+  notifications(std::make_shared<NotificationListener>(this->getConnectionString())),
+  types(std::make_shared<ReferenceCache>(this->pool, this->notifications)),
+  snapshots(std::make_shared<FlightCache>(this->notifications)) {}
 
 API::API(const API& api)
-: user(api.user), password(api.password) {}
+: user(api.user), password(api.password), pool(api.pool),
+  notifications(api.notifications), types(api.types), snapshots(api.snapshots) {}
 
 std::string API::getConnectionString() const {
     return "host=" + this->host + " port=" + this->port + " dbname=" 
@@ -18,6 +26,30 @@ std::string API::getConnectionString() const {
     + this->user + " password=" + this->password;
 }
 
-pqxx::connection API::begin() const {
-    return pqxx::connection(this->getConnectionString());
+// checks a connection out of the pool, it is returned once the handle goes out of scope
+PooledConnection API::begin() const {
+    return this->pool->acquire();
+}
+
+ReferenceCache& API::reference() const {
+    return *this->types;
+}
+
+FlightCache& API::flights() const {
+    return *this->snapshots;
+}
+
+// the transaction lives on a pooled connection, with more than one later
+// commands could check out another and run outside it
+void API::beginTransaction() const {
+    if(this->pool->size() != 1) throw std::logic_error("a batch transaction needs an API with a pool of one connection");
+    PooledConnection connection = this->begin();
+    connection.beginOuter();
+}
+
+void API::endTransaction(bool commit) const {
+    PooledConnection connection = this->begin();
+    connection.endOuter(commit);
+    // flights read inside the transaction may show changes that never happened
+    if(!commit) this->flights().clear();
 }
@@ -0,0 +1,232 @@
+#include "../inc/async.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+AsyncExecutor::AsyncExecutor(const API& api, std::size_t connections)
+: api(api), channels(std::max<std::size_t>(connections, 1)), queries(0) {}
+
+AsyncExecutor::~AsyncExecutor() {
+    for(auto& channel : this->channels) {
+        if(channel.connection) PQfinish(channel.connection);
+    }
+}
+
+bool AsyncExecutor::accepts(const CommandSpec& command) {
+    return command.stage != nullptr && command.async;
+}
+
+// starts connecting without waiting for the server, process() carries it on
+// as the socket becomes ready, false if it couldn't even start
+bool AsyncExecutor::open(Channel& channel) {
+    if(channel.connection && PQstatus(channel.connection) != CONNECTION_BAD) return true;
+    // broke since it was last used
+    if(channel.connection) this->fail(channel, PQerrorMessage(channel.connection));
+    channel.prepared.clear();
+    channel.connection = PQconnectStart(this->api.getConnectionString().c_str());
+    if(!channel.connection || PQstatus(channel.connection) == CONNECTION_BAD) {
+        if(channel.connection) Console::err() << PQerrorMessage(channel.connection);
+        PQfinish(channel.connection);
+        channel.connection = nullptr;
+        return false;
+    }
+    // libpq's first step is always a write
+    channel.polling = PGRES_POLLING_WRITING;
+    return true;
+}
+
+// one step of connecting once the socket is ready, then the commands that
+// waited for it go out together
+void AsyncExecutor::connect(Channel& channel) {
+    pollfd ready {PQsocket(channel.connection), static_cast<short>(channel.polling == PGRES_POLLING_READING ? POLLIN : POLLOUT), 0};
+    if(::poll(&ready, 1, 0) <= 0) return;
+
+    channel.polling = PQconnectPoll(channel.connection);
+    if(channel.polling == PGRES_POLLING_FAILED) return this->fail(channel, PQerrorMessage(channel.connection));
+    if(channel.polling != PGRES_POLLING_OK) return;
+
+    if(PQsetnonblocking(channel.connection, 1) != 0 || PQenterPipelineMode(channel.connection) != 1) {
+        return this->fail(channel, PQerrorMessage(channel.connection));
+    }
+    while(!channel.queued.empty()) {
+        if(!this->send(channel, channel.queued.front())) return this->fail(channel, PQerrorMessage(channel.connection));
+        channel.queued.pop_front();
+    }
+    channel.writing = PQflush(channel.connection) == 1;
+}
+
+// the connection is gone, so is everything that was waiting on it
+void AsyncExecutor::fail(Channel& channel, const std::string& message) {
+    std::deque<Pending> lost;
+    lost.swap(channel.inFlight);
+    for(auto& pending : channel.queued) lost.push_back(std::move(pending));
+    channel.queued.clear();
+    PQfinish(channel.connection);
+    channel.connection = nullptr;
+    channel.polling = PGRES_POLLING_FAILED;
+    channel.writing = false;
+    for(auto& pending : lost) {
+        if(pending.kind != Pending::query) continue;
+        --this->queries;
+        pending.done(Error::DBERROR, message);
+    }
+}
+
+// queues a command on a connected channel, left untouched if libpq refused it
+bool AsyncExecutor::send(Channel& channel, Pending& pending) {
+    // statements are prepared on first use in the same pipeline, an error in
+    // either aborts the rest up to the sync and comes back as the query's
+    const std::string& name = pending.staged.statement;
+    if(channel.prepared.insert(name).second) {
+        PQsendPrepare(channel.connection, name.c_str(), Statement::sql.at(name).c_str(), 0, nullptr);
+        Pending prepare;
+        prepare.kind = Pending::prepare;
+        prepare.name = name;
+        channel.inFlight.push_back(std::move(prepare));
+    }
+
+    std::vector<const char*> values;
+    for(const auto& param : pending.staged.params) values.push_back(param.c_str());
+    if(!PQsendQueryPrepared(channel.connection, name.c_str(), static_cast<int>(values.size()), values.data(), nullptr, nullptr, 0)
+       || !PQpipelineSync(channel.connection)) {
+        return false;
+    }
+    channel.inFlight.push_back(std::move(pending));
+    Pending sync;
+    sync.kind = Pending::sync;
+    channel.inFlight.push_back(std::move(sync));
+    return true;
+}
+
+void AsyncExecutor::submit(const CommandSpec& command, const args_t& args, callback_t done) {
+    Pending pending;
+    pending.kind = Pending::query;
+    pending.done = std::move(done);
+
+    std::ostringstream output;
+    {
+        Console::Redirect redirect(output);
+        error_t bound = command.stage ? command.stage(args, pending.staged) : Error::BADCMD;
+        if(bound == Error::SUCCESS && !pending.staged.async) bound = Error::BADCMD;
+        if(bound != Error::SUCCESS) return pending.done(bound, output.str());
+        if(Operation::answer(this->api, pending.staged)) return pending.done(Error::SUCCESS, output.str());
+    }
+    pending.epoch = this->api.flights().epoch();
+
+    // the least busy connection
+    Channel* channel = &this->channels.front();
+    for(auto& candidate : this->channels) {
+        if(candidate.inFlight.size() + candidate.queued.size() < channel->inFlight.size() + channel->queued.size()) channel = &candidate;
+    }
+    if(!this->open(*channel)) return pending.done(Error::DBERROR, "cannot connect\n");
+    ++this->queries;
+
+    // sent by connect() once the connection is up
+    if(channel->polling != PGRES_POLLING_OK) {
+        channel->queued.push_back(std::move(pending));
+        return;
+    }
+    if(!this->send(*channel, pending)) {
+        std::string message = PQerrorMessage(channel->connection);
+        this->fail(*channel, message);
+        --this->queries;
+        return pending.done(Error::DBERROR, message);
+    }
+
+    // whatever the socket won't take now is sent from process()
+    channel->writing = PQflush(channel->connection) == 1;
+}
+
+void AsyncExecutor::watch(std::vector<pollfd>& fds) const {
+    for(const auto& channel : this->channels) {
+        if(!channel.connection) continue;
+        if(channel.polling != PGRES_POLLING_OK) {
+            fds.push_back({PQsocket(channel.connection), static_cast<short>(channel.polling == PGRES_POLLING_READING ? POLLIN : POLLOUT), 0});
+            continue;
+        }
+        if(channel.inFlight.empty()) continue;
+        fds.push_back({PQsocket(channel.connection), static_cast<short>(POLLIN | (channel.writing ? POLLOUT : 0)), 0});
+    }
+}
+
+void AsyncExecutor::process() {
+    for(auto& channel : this->channels) {
+        if(channel.connection && channel.polling != PGRES_POLLING_OK) this->connect(channel);
+        if(!channel.connection || channel.inFlight.empty()) continue;
+        if(channel.writing) {
+            int flushed = PQflush(channel.connection);
+            if(flushed < 0) { this->fail(channel, PQerrorMessage(channel.connection)); continue; }
+            channel.writing = flushed == 1;
+        }
+        this->receive(channel);
+    }
+}
+
+// takes every result that has fully arrived, a query's results end with a
+// null and a sync's is a single PGRES_PIPELINE_SYNC
+void AsyncExecutor::receive(Channel& channel) {
+    if(!PQconsumeInput(channel.connection)) {
+        this->fail(channel, PQerrorMessage(channel.connection));
+        return;
+    }
+    while(!channel.inFlight.empty() && !PQisBusy(channel.connection)) {
+        PGresult* result = PQgetResult(channel.connection);
+        Pending& front = channel.inFlight.front();
+
+        if(front.kind == Pending::sync) {
+            PQclear(result);
+            channel.inFlight.pop_front();
+            continue;
+        }
+        if(result) {
+            // only the first result of a statement is kept
+            if(!front.result) front.result.reset(result, PQclear);
+            else PQclear(result);
+            continue;
+        }
+
+        Pending done = std::move(front);
+        channel.inFlight.pop_front();
+        if(done.kind == Pending::prepare) {
+            // prepared again next time, the query that needed it fails with the pipeline
+            if(!done.result || PQresultStatus(done.result.get()) != PGRES_COMMAND_OK) channel.prepared.erase(done.name);
+            continue;
+        }
+        --this->queries;
+        this->finish(done);
+    }
+}
+
+void AsyncExecutor::finish(Pending& pending) {
+    ExecStatusType status = pending.result ? PQresultStatus(pending.result.get()) : PGRES_FATAL_ERROR;
+    if(status != PGRES_TUPLES_OK && status != PGRES_COMMAND_OK) {
+        std::string message = status == PGRES_PIPELINE_ABORTED ? "statement could not be prepared\n"
+                            : pending.result ? PQresultErrorMessage(pending.result.get()) : "no result\n";
+        pending.done(Error::DBERROR, message);
+        return;
+    }
+
+    std::ostringstream output;
+    error_t handled;
+    {
+        Console::Redirect redirect(output);
+        handled = Operation::finish(this->api, pending.staged, AsyncResult(pending.result), pending.epoch);
+    }
+    pending.done(handled, output.str());
+}
+
+void AsyncExecutor::drain() {
+    std::vector<pollfd> fds;
+    while(this->queries > 0) {
+        fds.clear();
+        this->watch(fds);
+        if(fds.empty()) break;
+        if(poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) break;
+        this->process();
+    }
+}
+
+std::size_t AsyncExecutor::pending() const {
+    return this->queries;
+}
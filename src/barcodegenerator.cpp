@@ -0,0 +1,35 @@
+#include "../inc/barcodegenerator.h"
+
+std::mt19937_64& BarcodeGenerator::engine() {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    return generator;
+}
+
+// each 64 bit draw is cut into ten 6 bit indexes, the two that land past the
+// 62 character alphabet are rejected so every character stays equally likely
+void BarcodeGenerator::fill(char* out) {
+    std::mt19937_64& generator = engine();
+    std::size_t written = 0;
+    while(written < length) {
+        std::uint64_t bits = generator();
+        for(int chunk = 0; chunk < 10 && written < length; ++chunk, bits >>= 6) {
+            unsigned index = bits & 0x3f;
+            if(index < sizeof(alphabet) - 1) out[written++] = alphabet[index];
+        }
+    }
+}
+
+std::string BarcodeGenerator::next() {
+    std::string barcode(length, ' ');
+    fill(barcode.data());
+    return barcode;
+}
+
+std::vector<std::string> BarcodeGenerator::batch(std::size_t count) {
+    std::vector<std::string> barcodes;
+    barcodes.reserve(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        fill(barcodes.emplace_back(length, ' ').data());
+    }
+    return barcodes;
+}
@@ -0,0 +1,228 @@
+// benchmark for every Operation command
+// drives each command against the local airport database inside one
+// transaction that is rolled back at the end, so the data is left as it was,
+// and reports latency percentiles, throughput and heap allocations per call
+// seed the database first with make generate to benchmark at scale
+
+#include "../inc/operation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// every heap allocation in the process, sampled around each command
+static std::atomic<unsigned long> allocations(0);
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// the registered command of the same name runs each line, parsing included
+struct Bench {
+    std::string name;
+    // builds the command line for iteration i
+    std::function<std::string(std::size_t)> line;
+    // the flight cache is emptied before every call, so status reaches the database
+    bool uncached = false;
+};
+
+struct Result {
+    std::string name;
+    std::size_t iterations = 0;
+    std::size_t failures = 0;
+    double p50 = 0, p95 = 0, p99 = 0;
+    double perSecond = 0;
+    double allocationsPerCall = 0;
+};
+
+// value at quantile q of sorted samples
+static double quantile(const std::vector<double>& sorted, double q) {
+    if(sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(q * sorted.size()))];
+}
+
+static Result measure(const API& api, const Bench& bench, std::size_t iterations) {
+    Result result;
+    result.name = bench.uncached ? bench.name + " (uncached)" : bench.name;
+    result.iterations = iterations;
+
+    // command output is discarded so the terminal isn't part of the timing
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    std::streambuf* err = std::cerr.rdbuf(nullptr);
+
+    auto handler = Operation::find(bench.name)->run;
+
+    // the first call prepares the statement on the connection
+    Command warmup(bench.line(iterations));
+    handler(api, warmup.getArgs());
+
+    std::vector<Command> commands;
+    commands.reserve(iterations);
+    for(std::size_t i = 0; i < iterations; ++i) commands.emplace_back(bench.line(i));
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    unsigned long allocated = 0;
+    double total = 0;
+    for(const auto& command : commands) {
+        if(bench.uncached) api.flights().clear();
+        unsigned long before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        error_t status = handler(api, command.getArgs());
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+        allocated += allocations - before;
+        samples.push_back(took.count());
+        total += took.count();
+        if(status != Error::SUCCESS) ++result.failures;
+    }
+
+    std::cout.rdbuf(out);
+    std::cerr.rdbuf(err);
+
+    std::sort(samples.begin(), samples.end());
+    result.p50 = quantile(samples, 0.50);
+    result.p95 = quantile(samples, 0.95);
+    result.p99 = quantile(samples, 0.99);
+    result.perSecond = total > 0 ? iterations * 1000.0 / total : 0;
+    result.allocationsPerCall = iterations ? static_cast<double>(allocated) / iterations : 0;
+    return result;
+}
+
+static void writeJSON(std::ostream& os, const std::vector<Result>& results, std::size_t iterations) {
+    os << "{\n  \"iterations\": " << iterations << ",\n  \"commands\": [\n";
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"p50_ms\": " << r.p50 << ", \"p95_ms\": " << r.p95
+           << ", \"p99_ms\": " << r.p99 << ", \"per_second\": " << r.perSecond
+           << ", \"allocations_per_call\": " << r.allocationsPerCall << ", \"failures\": " << r.failures << '}'
+           << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    os << "  ]\n}" << std::endl;
+}
+
+static int usage() {
+    std::cerr << "usage: bench.out [--iterations n] [--json <file>] [--only <command>]\n"
+              << "  connects as $AIRPORT_USER with $AIRPORT_PASSWORD" << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+
+    std::size_t iterations = 200;
+    std::string json;
+    std::string only;
+    const char* user = std::getenv("AIRPORT_USER");
+    const char* password = std::getenv("AIRPORT_PASSWORD");
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "--iterations" && i + 1 < argc) iterations = std::stoul(argv[++i]);
+        else if(arg == "--json" && i + 1 < argc) json = argv[++i];
+        else if(arg == "--only" && i + 1 < argc) only = argv[++i];
+        else return usage();
+    }
+    if(!user || iterations == 0) return usage();
+
+    API api(user, password ? password : "", 1);
+    api.beginTransaction();
+
+    // active flights and airports to spread the commands over
+    int standby, delayed, home;
+    if(!api.reference().warm()) return 1;
+    if(!api.reference().status("Standby", standby) || !api.reference().status("Delayed", delayed) || !api.reference().location(ReferenceCache::home, home)) {
+        std::cerr << "the Standby and Delayed statuses and the home airport have to exist, load db/airport.sql" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> flights;
+    std::vector<std::string> airports;
+    {
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        std::string active = "SELECT DISTINCT flight_number FROM Flight WHERE status_id IN (" + std::to_string(standby) + ", " + std::to_string(delayed) + ") LIMIT 1000";
+        for(const auto& row : query->exec(active)) {
+            flights.push_back(row[0].as<std::string>());
+        }
+        for(const auto& row : query->exec("SELECT icao FROM LocationType WHERE id <> " + std::to_string(home))) {
+            airports.push_back(row[0].as<std::string>());
+        }
+        query->commit();
+    }
+    if(flights.empty() || airports.empty()) {
+        std::cerr << "no active flights to benchmark, load db/airport.sql or run make generate" << std::endl;
+        return 1;
+    }
+
+    auto flight = [&](std::size_t i) { return flights[i % flights.size()]; };
+    auto airport = [&](std::size_t i) { return airports[i % airports.size()]; };
+    // the same barcodes are added and then removed
+    auto cargoBarcode = [](std::size_t i) {
+        std::string barcode = "BENCH0000000";
+        for(std::size_t at = barcode.size(); at > 5 && i > 0; --at, i /= 10) barcode[at - 1] = '0' + i % 10;
+        return barcode;
+    };
+    auto number = [](std::size_t i) {
+        std::string digits = std::to_string(i % 10000);
+        return "ZZ" + std::string(4 - digits.size(), '0') + digits;
+    };
+
+    const std::vector<Bench> benches = {
+        {"status", [&](std::size_t i) { return "status " + flight(i); }},
+        {"status", [&](std::size_t i) { return "status " + flight(i); }, true},
+        {"list", [](std::size_t) { return std::string("list --limit 100"); }},
+        {"depart", [&](std::size_t i) { return "depart " + airport(i); }},
+        {"arrive", [&](std::size_t i) { return "arrive " + airport(i); }},
+        {"meals", [&](std::size_t i) { return "meals " + flight(i); }},
+        {"mealTypes", [&](std::size_t i) { return "mealTypes " + flight(i); }},
+        {"checkCargo", [&](std::size_t i) { return "checkCargo " + flight(i); }},
+        {"addCargo", [&](std::size_t i) { return "addCargo " + flight(i) + " 10 " + cargoBarcode(i); }},
+        {"removeCargo", [&](std::size_t i) { return "removeCargo " + flight(i) + " " + cargoBarcode(i); }},
+        {"delay", [&](std::size_t i) { return "delay " + flight(i) + " 00:05:00"; }},
+        {"changeStatus", [&](std::size_t i) { return "changeStatus " + flight(i) + " Delayed"; }},
+        {"changeDestination", [&](std::size_t i) { return "changeDestination " + flight(i) + " " + airport(i); }},
+        {"changeOrigin", [&](std::size_t i) { return "changeOrigin " + flight(i) + " " + airport(i); }},
+        {"passengers", [&](std::size_t i) { return "passengers " + flight(i) + " +1"; }},
+        {"create", [&](std::size_t i) {
+            return "create " + number(i) + " \"2031-03-01 12:00:00\" \"2031-03-01 14:00:00\" A3 \"Boeing 787\" " + airport(i) + " KDTW \"Alaskan Airlines\"";
+        }},
+    };
+
+    std::vector<Result> results;
+    for(const auto& bench : benches) {
+        if(!only.empty() && bench.name != only) continue;
+        results.push_back(measure(api, bench, iterations));
+    }
+
+    // nothing the benchmark did is kept
+    api.endTransaction(false);
+
+    std::cout << std::left << std::setw(20) << "command" << std::right
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+              << std::setw(12) << "per sec" << std::setw(10) << "allocs" << std::setw(10) << "failed" << '\n'
+              << std::fixed << std::setprecision(3);
+    for(const auto& r : results) {
+        std::cout << std::left << std::setw(20) << r.name << std::right
+                  << std::setw(10) << r.p50 << std::setw(10) << r.p95 << std::setw(10) << r.p99
+                  << std::setprecision(1) << std::setw(12) << r.perSecond << std::setw(10) << r.allocationsPerCall
+                  << std::setprecision(3) << std::setw(10) << r.failures << '\n';
+    }
+    std::cout.flush();
+
+    if(!json.empty()) {
+        std::ofstream file(json);
+        if(!file) { std::cerr << "cannot write " << json << std::endl; return 1; }
+        writeJSON(file, results, iterations);
+    }
+    return 0;
+}
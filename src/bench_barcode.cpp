@@ -0,0 +1,74 @@
+// microbenchmark for barcode generation
+// compares BarcodeGenerator against the generate_random_string it replaced,
+// which seeded a new engine from std::random_device for every barcode
+
+#include "../inc/barcodegenerator.h"
+#include "../inc/validate.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+namespace previous {
+    std::string generate_random_string(int length) {
+        std::string str("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
+        std::random_device rd;
+        std::mt19937 generator(rd());
+        std::uniform_int_distribution<> distr(0, str.size() - 1);
+        std::string random_string;
+        for (int n = 0; n < length; ++n)
+            random_string += str[distr(generator)];
+        return random_string;
+    }
+}
+
+template<typename F>
+static double nsPerBarcode(const F& f, std::size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t produced = f(count);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / produced;
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    volatile std::size_t sink = 0;
+
+    // every barcode has to be valid and a batch this size shouldn't repeat
+    std::size_t invalid = 0;
+    std::unordered_set<std::string> seen;
+    for(const auto& barcode : BarcodeGenerator::batch(count)) {
+        if(!Validate::barcode(barcode)) ++invalid;
+        seen.insert(barcode);
+    }
+    std::size_t duplicates = count - seen.size();
+
+    double before = nsPerBarcode([&](std::size_t n) {
+        for(std::size_t i = 0; i < n; ++i) sink = sink + previous::generate_random_string(12)[0];
+        return n;
+    }, count);
+    double single = nsPerBarcode([&](std::size_t n) {
+        for(std::size_t i = 0; i < n; ++i) sink = sink + BarcodeGenerator::next()[0];
+        return n;
+    }, count);
+    // batches the size of a full widebody
+    double batched = nsPerBarcode([&](std::size_t n) {
+        for(std::size_t i = 0; i < n; i += 300) sink = sink + BarcodeGenerator::batch(300).size();
+        return (n + 299) / 300 * 300;
+    }, count);
+
+    std::cout << std::left << std::setw(24) << "generator" << std::right << std::setw(12) << "ns/barcode"
+              << std::setw(10) << "speedup" << '\n' << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(24) << "generate_random_string" << std::right << std::setw(12) << before
+              << std::setw(9) << 1.0 << "x\n";
+    std::cout << std::left << std::setw(24) << "BarcodeGenerator::next" << std::right << std::setw(12) << single
+              << std::setw(9) << before / single << "x\n";
+    std::cout << std::left << std::setw(24) << "BarcodeGenerator::batch" << std::right << std::setw(12) << batched
+              << std::setw(9) << before / batched << "x\n";
+    std::cout << invalid << " invalid, " << duplicates << " duplicate in " << count << std::endl;
+
+    return invalid == 0 && duplicates == 0 ? 0 : 1;
+}
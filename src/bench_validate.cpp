@@ -0,0 +1,118 @@
+// microbenchmark for the argument validators
+// compares the compile time matchers in validate.h against the std::regex
+// versions they replaced, and checks both agree on every input
+
+#include "../inc/validate.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+static_assert(Validate::barcode("ABECEECE1231"));
+static_assert(!Validate::barcode("ABECEECE123"));
+static_assert(Validate::flightNumber("AL001") && !Validate::flightNumber("A1001"));
+static_assert(Validate::dateTime("2021-03-01 12:00:00"));
+static_assert(Validate::time("00:30:01") && Validate::time("23:59:59.999") && !Validate::time("24:00:00"));
+static_assert(Validate::icao("KJFK") && !Validate::icao("KJF"));
+static_assert(Validate::gate("A3") && Validate::gate("B12") && !Validate::gate("B123"));
+static_assert(Validate::weight("1000") && Validate::weight("10.5") && !Validate::weight("10."));
+static_assert(Validate::status("In Transit") && !Validate::status("Landed"));
+
+// the validators as they were, building a regex on every call
+namespace previous {
+    bool barcode(const std::string& s) { return std::regex_match(s, std::regex("[a-zA-Z0-9]{12}")); }
+    bool flightNumber(const std::string& s) { return std::regex_match(s, std::regex("[A-Z]{2}[0-9]{2,4}")); }
+    bool dateTime(const std::string& s) { return std::regex_match(s, std::regex("[0-9]{4}-[0-9]{2}-[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2}")); }
+    bool time(const std::string& s) { return std::regex_match(s, std::regex("^(?:[01][0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9](?:\\.[0-9]{1,3})?$")); }
+    bool icao(const std::string& s) { return std::regex_match(s, std::regex("[A-Z]{4}")); }
+    bool gate(const std::string& s) { return std::regex_match(s, std::regex("[A-Z][0-9]{1,2}")); }
+    bool airplane(const std::string& s) { return std::regex_match(s, std::regex("[a-zA-Z0-9 ]+")); }
+    bool airline(const std::string& s) { return std::regex_match(s, std::regex("[a-zA-Z ]+")); }
+    bool weight(const std::string& s) { return std::regex_match(s, std::regex("[0-9]+(\\.[0-9]+)?")); }
+    bool status(const std::string& s) { return std::regex_match(s, std::regex("(Standby|Boarding|Departed|Delayed|In Transit|Arrived|Cancelled)")); }
+}
+
+struct Case {
+    std::string name;
+    std::function<bool(const std::string&)> before;
+    std::function<bool(const std::string&)> after;
+    std::vector<std::string> inputs;
+};
+
+// random strings over the characters the formats care about
+static std::vector<std::string> fuzz(std::size_t count) {
+    const std::string alphabet = "0123456789AZaz :-.Q";
+    std::mt19937 generator(475);
+    std::uniform_int_distribution<> length(0, 20);
+    std::uniform_int_distribution<> pick(0, alphabet.size() - 1);
+    std::vector<std::string> out;
+    for(std::size_t i = 0; i < count; ++i) {
+        std::string s(length(generator), ' ');
+        for(auto& c : s) c = alphabet[pick(generator)];
+        out.push_back(s);
+    }
+    return out;
+}
+
+template<typename F>
+static double nsPerCall(const F& f, const std::vector<std::string>& inputs, std::size_t iterations) {
+    volatile std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < iterations; ++i) {
+        for(const auto& input : inputs) sink = sink + f(input);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (iterations * inputs.size());
+}
+
+int main(int argc, char** argv) {
+    std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+    std::vector<Case> cases = {
+        {"barcode", previous::barcode, Validate::barcode, {"ABECEECE1231", "QV5H0D5R5O5W", "short", "ABECEECE123!"}},
+        {"flightNumber", previous::flightNumber, Validate::flightNumber, {"AL001", "AA1234", "A1", "aa123"}},
+        {"dateTime", previous::dateTime, Validate::dateTime, {"2021-03-01 12:00:00", "2021-03-01T12:00:00", "2021-3-1 1:00:00"}},
+        {"time", previous::time, Validate::time, {"00:30:01", "23:59:59.5", "24:00:00", "1:00:00"}},
+        {"icao", previous::icao, Validate::icao, {"KJFK", "KDTW", "kjfk", "KJFKX"}},
+        {"gate", previous::gate, Validate::gate, {"A3", "B12", "3A", "C123"}},
+        {"airplane", previous::airplane, Validate::airplane, {"Boeing 787", "McDonnell Douglas MD-80", ""}},
+        {"airline", previous::airline, Validate::airline, {"American Airlines", "Delta 1", ""}},
+        {"weight", previous::weight, Validate::weight, {"1000", "48.4", "10.", ".5"}},
+        {"status", previous::status, Validate::status, {"Boarding", "In Transit", "Landed", "boarding"}},
+    };
+
+    // both implementations have to agree before timing means anything
+    std::vector<std::string> extra = fuzz(20000);
+    std::size_t mismatches = 0;
+    for(const auto& c : cases) {
+        std::vector<std::string> all = c.inputs;
+        all.insert(all.end(), extra.begin(), extra.end());
+        for(const auto& input : all) {
+            if(c.before(input) != c.after(input)) {
+                std::cerr << c.name << " disagrees on \"" << input << "\"\n";
+                ++mismatches;
+            }
+        }
+    }
+
+    std::cout << std::left << std::setw(14) << "validator"
+              << std::right << std::setw(14) << "regex ns/op"
+              << std::setw(16) << "matcher ns/op"
+              << std::setw(10) << "speedup" << '\n';
+    for(const auto& c : cases) {
+        double before = nsPerCall(c.before, c.inputs, iterations / 10 + 1);
+        double after = nsPerCall([&](const std::string& s) { return c.after(s); }, c.inputs, iterations * 10);
+        std::cout << std::left << std::setw(14) << c.name
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << before
+                  << std::setw(16) << after
+                  << std::setw(9) << before / after << 'x' << '\n';
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// query plan regression check
+// runs EXPLAIN on every statement in the registry against the local airport
+// database and fails if any of them scans one of the large tables
+// sequentially, sequential scans are priced out so a seq scan in a plan means
+// no index could serve it rather than the table being small
+
+#include "../inc/statement.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// tables that grow with traffic, the rest are small fixed lookups
+static const std::vector<std::string> large = {"flight", "passenger", "cargo", "mealtoflight"};
+
+// parameters to plan each statement with, a statement without an entry fails
+// the check so new ones get covered
+static const std::map<std::string, std::vector<std::string>> samples = {
+    {"get_flight", {"AL001"}},
+    {"get_flights", {"{AL001,AA123}"}},
+    {"CreateFlight", {"AA123", "2021-03-01 12:00:00", "2021-03-01 14:00:00", "3", "1", "1", "3", "1", "1", "6", "7"}},
+    {"get_destinations", {"KDTW"}},
+    {"get_arrivals", {"KDTW"}},
+    {"add_cargo", {"AL001", "1000", "ABECEECE1231"}},
+    {"all_flights", {"-infinity", "0", "0", "0"}},
+    {"delay_flight", {"AL001", "00:30:01"}},
+    {"getMeals", {"AL001"}},
+    {"check_cargo", {"AL001"}},
+    {"cargo_capacity", {"AL001"}},
+    {"CheckMealType", {"AL001"}},
+    {"add_passengers", {"AL001", "{ABECEECE1231}"}},
+    {"remove_passengers", {"AL001", "1"}},
+    {"update_status", {"AL001", "2"}},
+    {"remove_cargo", {"AL001", "ABECEECE1231"}},
+    {"update_destination", {"AL001", "3", "1", "4", "1"}},
+    {"update_origin", {"AL001", "4", "1", "4", "1"}},
+    {"recount_cargo", {"1"}},
+    {"recount", {"false"}},
+};
+
+// statements that read whole tables on purpose
+static const std::vector<std::string> sweeps = {"recount"};
+
+static std::string lower(std::string s) {
+    for(auto& c : s) c = std::tolower(static_cast<unsigned char>(c));
+    return s;
+}
+
+int main() {
+    const char* user = std::getenv("AIRPORT_USER");
+    const char* password = std::getenv("AIRPORT_PASSWORD");
+    if(!user) {
+        std::cerr << "set AIRPORT_USER and AIRPORT_PASSWORD" << std::endl;
+        return 2;
+    }
+
+    pqxx::connection connection("host=localhost port=5432 dbname=airport user=" + std::string(user)
+                                + " password=" + std::string(password ? password : ""));
+    unsigned failed = 0;
+
+    for(const auto& [name, text] : Statement::sql) {
+        if(std::find(sweeps.begin(), sweeps.end(), name) != sweeps.end()) {
+            std::cout << "skip " << name << ": reads every flight" << std::endl;
+            continue;
+        }
+        auto sample = samples.find(name);
+        if(sample == samples.end()) {
+            std::cout << "FAIL " << name << ": no sample parameters" << std::endl;
+            ++failed;
+            continue;
+        }
+
+        // explain never runs the statement, the rollback is only for the setting
+        pqxx::work query(connection);
+        query.exec("SET LOCAL enable_seqscan = off");
+        pqxx::result plan = query.exec("EXPLAIN " + Statement::expand(query, name, sample->second));
+        query.abort();
+
+        std::vector<std::string> scanned;
+        for(const auto& row : plan) {
+            std::string line = lower(row[0].as<std::string>());
+            std::size_t at = line.find("seq scan on ");
+            if(at == std::string::npos) continue;
+            std::string table = line.substr(at + 12, line.find(' ', at + 12) - at - 12);
+            for(const auto& big : large) {
+                if(table == big) scanned.push_back(table);
+            }
+        }
+
+        if(scanned.empty()) {
+            std::cout << "ok   " << name << std::endl;
+            continue;
+        }
+        ++failed;
+        std::cout << "FAIL " << name << ": sequential scan on";
+        for(const auto& table : scanned) std::cout << ' ' << table;
+        std::cout << '\n';
+        for(const auto& row : plan) std::cout << "    " << row[0].as<std::string>() << '\n';
+    }
+
+    std::cout << Statement::sql.size() << " statements, " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -1,14 +1,94 @@
 #include "../inc/command.h"
 
+#include <cctype>
+
 // constructors
 Command::Command(){};
 
-Command::Command(const std::string& command, const std::list<std::string> args) 
-    : command(command), args(args) {
+Command::Command(std::string line)
+    : line(std::move(line)) {
+    this->tokenize();
+}
+
+Command::Command(const Command& c)
+    : line(c.line) {
+    this->rebase(c, c.line.data());
+}
+
+// a short line is kept inside the string itself and is copied rather than
+// handed over, so the views are rebased after a move too
+Command::Command(Command&& c) {
+    const char* from = c.line.data();
+    this->line = std::move(c.line);
+    this->rebase(c, from);
+    c.line.clear();
+    c.command = std::string_view();
+    c.args.clear();
+}
+
+Command& Command::operator=(const Command& c) {
+    if(this == &c) return *this;
+    this->line = c.line;
+    this->rebase(c, c.line.data());
+    return *this;
+}
+
+Command& Command::operator=(Command&& c) {
+    if(this == &c) return *this;
+    const char* from = c.line.data();
+    this->line = std::move(c.line);
+    this->rebase(c, from);
+    c.line.clear();
+    c.command = std::string_view();
+    c.args.clear();
+    return *this;
+}
+
+// splits the line in place into whitespace separated tokens
+// "double quotes" group words into one token and a backslash escapes the
+// next character, both are removed by shifting the token's characters left
+// so every token stays a view into the line and nothing is allocated
+void Command::tokenize() {
+    char* buffer = this->line.data();
+    std::size_t size = this->line.size();
+    std::size_t read = 0;
+    std::size_t write = 0;
+    bool first = true;
+
+    while(read < size) {
+        while(read < size && std::isspace(static_cast<unsigned char>(buffer[read]))) ++read;
+        if(read == size) break;
+
+        std::size_t start = write;
+        bool quoted = false;
+        while(read < size) {
+            char c = buffer[read];
+            if(!quoted && std::isspace(static_cast<unsigned char>(c))) break;
+            if(c == '"') {
+                quoted = !quoted;
+                ++read;
+                continue;
+            }
+            if(c == '\\' && read + 1 < size) ++read;
+            buffer[write++] = buffer[read++];
+        }
+
+        std::string_view token(buffer + start, write - start);
+        if(first) this->command = token;
+        else this->args.push_back(token);
+        first = false;
+    }
 }
 
-Command::Command(const Command& c) 
-    : command(c.command), args(c.args) {
+// points c's views, which look into the line starting at from, at this line
+void Command::rebase(const Command& c, const char* from) {
+    const char* to = this->line.data();
+    this->command = c.command.data() != nullptr ? std::string_view(to + (c.command.data() - from), c.command.size()) : std::string_view();
+    args_t args;
+    for(const auto& arg : c.args) {
+        args.push_back(std::string_view(to + (arg.data() - from), arg.size()));
+    }
+    this->args = args;
 }
 
 // ostream for debugging
@@ -21,9 +101,9 @@ std::ostream& operator<<(std::ostream& os, const Command& c) {
 }
 
 // getters
-std::string Command::getCommand() const {
+std::string_view Command::getCommand() const {
     return this->command;
 }
-const std::list<std::string>& Command::getArgs() const {
+const args_t& Command::getArgs() const {
     return this->args;
 }
@@ -0,0 +1,18 @@
+#include "../inc/console.h"
+
+thread_local std::ostream* Console::output = &std::cout;
+thread_local std::ostream* Console::errors = &std::cerr;
+
+std::ostream& Console::out() { return *Console::output; }
+std::ostream& Console::err() { return *Console::errors; }
+
+Console::Redirect::Redirect(std::ostream& stream)
+: output(Console::output), errors(Console::errors) {
+    Console::output = &stream;
+    Console::errors = &stream;
+}
+
+Console::Redirect::~Redirect() {
+    Console::output = this->output;
+    Console::errors = this->errors;
+}
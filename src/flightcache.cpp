@@ -0,0 +1,71 @@
+#include "../inc/flightcache.h"
+
+const std::string FlightCache::channel = "flight_changed";
+const std::size_t FlightCache::capacity = 4096;
+
+FlightCache::FlightCache(std::shared_ptr<NotificationListener> listener)
+: listener(std::move(listener)), generation(0), hitCount(0), missCount(0) {
+    // the payload is the flight number that changed, anything else drops everything
+    this->listener->subscribe(FlightCache::channel,
+        [this](const std::string& payload) {
+            FlightNumber flightNum;
+            if(FlightNumber::parse(payload, flightNum)) this->invalidate(flightNum);
+            else this->clear();
+        },
+        [this]() { this->clear(); });
+}
+
+bool FlightCache::find(FlightNumber flightNum, snapshot_t& snapshot, unsigned long& epoch) {
+    // without the listener nothing would tell us a flight changed
+    if(!this->listener->poll()) this->clear();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    epoch = this->generation;
+    auto found = this->entries.find(flightNum);
+    if(found == this->entries.end()) {
+        ++this->missCount;
+        return false;
+    }
+    this->order.splice(this->order.begin(), this->order, found->second.position);
+    snapshot = found->second.snapshot;
+    ++this->hitCount;
+    return true;
+}
+
+void FlightCache::store(FlightNumber flightNum, snapshot_t snapshot, unsigned long epoch) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if(epoch != this->generation) return;
+
+    auto found = this->entries.find(flightNum);
+    if(found != this->entries.end()) {
+        found->second.snapshot = std::move(snapshot);
+        this->order.splice(this->order.begin(), this->order, found->second.position);
+        return;
+    }
+    if(this->entries.size() >= FlightCache::capacity) {
+        this->entries.erase(this->order.back());
+        this->order.pop_back();
+    }
+    this->order.push_front(flightNum);
+    this->entries.emplace(flightNum, Entry{std::move(snapshot), this->order.begin()});
+}
+
+void FlightCache::invalidate(FlightNumber flightNum) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->generation;
+    auto found = this->entries.find(flightNum);
+    if(found == this->entries.end()) return;
+    this->order.erase(found->second.position);
+    this->entries.erase(found);
+}
+
+void FlightCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->generation;
+    this->entries.clear();
+    this->order.clear();
+}
+
+unsigned long FlightCache::epoch() const { return this->generation; }
+unsigned long FlightCache::hits() const { return this->hitCount; }
+unsigned long FlightCache::misses() const { return this->missCount; }
@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../inc/generator.h"
+
+static int usage() {
+    std::cerr << "usage: generate.out [--flights n] [--passengers n] [--cargo n] [--meals n] [--seed n]\n"
+              << "  adds n flights and n passengers and cargo in total to the airport database\n"
+              << "  connects as $AIRPORT_USER with $AIRPORT_PASSWORD" << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+
+    Generator::Scale scale;
+    const char* user = std::getenv("AIRPORT_USER");
+    const char* password = std::getenv("AIRPORT_PASSWORD");
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(i + 1 >= argc) return usage();
+        std::uint64_t value = std::strtoull(argv[++i], nullptr, 10);
+        if(arg == "--flights") scale.flights = value;
+        else if(arg == "--passengers") scale.passengers = value;
+        else if(arg == "--cargo") scale.cargo = value;
+        else if(arg == "--meals") scale.mealsPerFlight = value;
+        else if(arg == "--seed") scale.seed = value;
+        else return usage();
+    }
+    if(!user || scale.flights == 0) return usage();
+
+    try {
+        pqxx::connection connection("host=localhost port=5432 dbname=airport user=" + std::string(user)
+                                    + " password=" + std::string(password ? password : ""));
+        Generator generator(connection, scale);
+
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t rows = generator.run();
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        std::cerr << rows << " rows in " << took.count() << " s, "
+                  << static_cast<std::uint64_t>(rows / took.count()) << " rows/sec" << std::endl;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "../inc/generator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+Generator::Generator(pqxx::connection& connection, const Scale& scale)
+: connection(connection), scale(scale), engine(scale.seed) {}
+
+void Generator::loadReference() {
+    pqxx::nontransaction query(this->connection);
+    for(const auto& row : query.exec("SELECT id FROM GateType ORDER BY id")) this->gates.push_back(row[0].as<int>());
+    for(const auto& row : query.exec("SELECT id FROM AirlineType ORDER BY id")) this->airlines.push_back(row[0].as<int>());
+    for(const auto& row : query.exec("SELECT id FROM LocationType WHERE id <> 1 ORDER BY id")) this->locations.push_back(row[0].as<int>());
+    for(const auto& row : query.exec("SELECT id FROM MealType ORDER BY id")) this->meals.push_back(row[0].as<int>());
+    for(const auto& row : query.exec("SELECT id, max_cargo, max_passengers FROM AirplaneType ORDER BY id")) {
+        this->airplanes.push_back({row[0].as<int>(), row[1].as<double>(), row[2].as<int>()});
+    }
+    if(this->gates.empty() || this->airlines.empty() || this->locations.empty() || this->airplanes.empty()) {
+        throw std::runtime_error("reference tables are empty, load db/airport.sql first");
+    }
+
+    pqxx::row next = query.exec1(
+        "SELECT (SELECT COALESCE(MAX(id), 0) + 1 FROM Flight), "
+        "(SELECT COALESCE(MAX(id), 0) + 1 FROM Passenger), "
+        "(SELECT COALESCE(MAX(id), 0) + 1 FROM Cargo)");
+    this->nextFlight = next[0].as<std::uint64_t>();
+    this->nextPassenger = next[1].as<std::uint64_t>();
+    this->nextCargo = next[2].as<std::uint64_t>();
+}
+
+// uniform in [low, high]
+std::uint64_t Generator::between(std::uint64_t low, std::uint64_t high) {
+    return std::uniform_int_distribution<std::uint64_t>(low, high)(this->engine);
+}
+
+template<typename T>
+const T& Generator::pick(const std::vector<T>& values) {
+    return values[this->between(0, values.size() - 1)];
+}
+
+// how many of total fall to one of count flights, varying around the mean
+// by up to half so flights aren't all the same size
+std::uint64_t Generator::share(std::uint64_t total, std::uint64_t count) {
+    std::uint64_t mean = total / count;
+    if(mean == 0) return this->between(0, total * 2 >= count ? 1 : 0);
+    return this->between(mean - mean / 2, mean + mean / 2);
+}
+
+std::string Generator::timestamp(std::time_t when) {
+    std::tm parts;
+    gmtime_r(&when, &parts);
+    char buffer[20];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &parts);
+    return buffer;
+}
+
+// SYN followed by the id in base 36, unique per passenger and still [a-zA-Z0-9]{12}
+std::string Generator::barcode(std::uint64_t id) {
+    static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string out = "SYN000000000";
+    for(std::size_t i = out.size(); i > 3 && id > 0; --i, id /= 36) out[i - 1] = digits[id % 36];
+    return out;
+}
+
+// writes count flights and remembers what their children need
+void Generator::flights(std::vector<Flight>& out, std::uint64_t count) {
+    // departures spread over three years, most of them already flown
+    const std::time_t now = std::time(nullptr);
+    const std::time_t earliest = now - 3 * 365 * 24 * 3600L;
+    const std::time_t latest = now + 60 * 24 * 3600L;
+
+    pqxx::work query(this->connection);
+    pqxx::stream_to stream(query, "flight", std::vector<std::string>{
+        "id", "flight_number", "departure_time", "arrival_time", "gate_id",
+        "status_id", "airplane_id", "airline_id", "destination_id", "origin_id"});
+
+    for(std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t id = this->nextFlight++;
+        const Airplane& airplane = this->pick(this->airplanes);
+
+        std::time_t departure = this->between(earliest, latest);
+        std::time_t arrival = departure + this->between(45 * 60, 14 * 3600);
+
+        // flights in the past are finished, a few of everything else is cancelled
+        int status;
+        if(arrival < now) status = this->between(0, 49) == 0 ? Generator::cancelled : Generator::arrived;
+        else if(departure < now) status = this->between(3, 5);
+        else status = this->between(0, 49) == 0 ? Generator::cancelled : this->between(1, 4);
+
+        // [A-Z]{2}[0-9]{4}
+        std::string number = "AA0000";
+        number[0] = 'A' + id / 260000 % 26;
+        number[1] = 'A' + id / 10000 % 26;
+        for(int digit = 5, rest = id % 10000; digit > 1; --digit, rest /= 10) number[digit] = '0' + rest % 10;
+
+        int other = this->pick(this->locations);
+        bool outbound = this->between(0, 1) == 0;
+        stream << std::make_tuple(id, number, timestamp(departure), timestamp(arrival), this->pick(this->gates),
+                                  status, airplane.id, this->pick(this->airlines),
+                                  outbound ? other : Generator::home, outbound ? Generator::home : other);
+        out.push_back({id, &airplane});
+        ++this->rows;
+    }
+
+    stream.complete();
+    query.commit();
+}
+
+// passengers, cargo and meals for one chunk of flights, kept within each airplane's limits
+void Generator::children(const std::vector<Flight>& chunk) {
+    pqxx::work query(this->connection);
+
+    {
+        pqxx::stream_to stream(query, "passenger", std::vector<std::string>{"id", "flight_id", "barcode"});
+        for(const auto& flight : chunk) {
+            std::uint64_t count = std::min<std::uint64_t>(this->share(this->scale.passengers, this->scale.flights), flight.airplane->maxPassengers);
+            for(std::uint64_t i = 0; i < count; ++i) {
+                std::uint64_t id = this->nextPassenger++;
+                stream << std::make_tuple(id, flight.id, barcode(id));
+                ++this->rows;
+            }
+        }
+        stream.complete();
+    }
+
+    {
+        pqxx::stream_to stream(query, "cargo", std::vector<std::string>{"id", "flight_id", "weight_lb", "barcode"});
+        for(const auto& flight : chunk) {
+            std::uint64_t count = this->share(this->scale.cargo, this->scale.flights);
+            double load = 0;
+            for(std::uint64_t i = 0; i < count; ++i) {
+                double weight = this->between(10, 3000) / 10.0;
+                if(load + weight > flight.airplane->maxCargo) break;
+                load += weight;
+                std::uint64_t id = this->nextCargo++;
+                stream << std::make_tuple(id, flight.id, weight, barcode(id));
+                ++this->rows;
+            }
+        }
+        stream.complete();
+    }
+
+    if(!this->meals.empty()) {
+        pqxx::stream_to stream(query, "mealtoflight", std::vector<std::string>{"flight_id", "meal_id"});
+        unsigned count = std::min<std::size_t>(this->scale.mealsPerFlight, this->meals.size());
+        for(const auto& flight : chunk) {
+            // a run of consecutive meals from a random start keeps them distinct
+            std::size_t start = this->between(0, this->meals.size() - 1);
+            for(unsigned i = 0; i < count; ++i) {
+                stream << std::make_tuple(flight.id, this->meals[(start + i) % this->meals.size()]);
+                ++this->rows;
+            }
+        }
+        stream.complete();
+    }
+
+    // the counters the shell keeps on each flight, filled from what was just streamed
+    query.exec(
+        "UPDATE Flight "
+        "SET passenger_count = (SELECT count(*) FROM Passenger WHERE Passenger.flight_id = Flight.id), "
+            "cargo_weight_total = (SELECT COALESCE(SUM(weight_lb), 0) FROM Cargo WHERE Cargo.flight_id = Flight.id) "
+        "WHERE Flight.id BETWEEN " + std::to_string(chunk.front().id) + " AND " + std::to_string(chunk.back().id));
+
+    query.commit();
+}
+
+std::uint64_t Generator::run() {
+    this->loadReference();
+    std::uint64_t firstFlight = this->nextFlight;
+    std::uint64_t firstPassenger = this->nextPassenger;
+    std::uint64_t firstCargo = this->nextCargo;
+
+    std::vector<Flight> chunk;
+    chunk.reserve(Generator::chunk);
+    while(this->nextFlight - firstFlight < this->scale.flights) {
+        chunk.clear();
+        this->flights(chunk, std::min(Generator::chunk, this->scale.flights - (this->nextFlight - firstFlight)));
+        this->children(chunk);
+        std::cerr << this->nextFlight - firstFlight << " flights, "
+                  << this->nextPassenger - firstPassenger << " passengers, "
+                  << this->nextCargo - firstCargo << " cargo" << std::endl;
+    }
+
+    // serial columns carry on after the generated ids
+    pqxx::nontransaction query(this->connection);
+    query.exec("SELECT setval('flight_id_seq', (SELECT MAX(id) FROM Flight))");
+    query.exec("SELECT setval('passenger_id_seq', (SELECT MAX(id) FROM Passenger))");
+    query.exec("SELECT setval('cargo_id_seq', (SELECT MAX(id) FROM Cargo))");
+    query.exec("ANALYZE");
+
+    return this->rows;
+}
@@ -0,0 +1,46 @@
+#include "../inc/listener.h"
+
+#include <iostream>
+
+NotificationListener::Receiver::Receiver(pqxx::connection& connection, const std::string& channel, handler_t handler)
+: pqxx::notification_receiver(connection, channel), handler(std::move(handler)) {}
+
+void NotificationListener::Receiver::operator()(const std::string& payload, int) {
+    this->handler(payload);
+}
+
+NotificationListener::NotificationListener(const std::string& connectionString)
+: connectionString(connectionString) {}
+
+// a new session has to LISTEN again, the receivers do that as they are built
+void NotificationListener::reconnect() {
+    this->receivers.clear();
+    this->connection = std::make_unique<pqxx::connection>(this->connectionString);
+    for(const auto& subscription : this->subscriptions) {
+        this->receivers.push_back(std::make_unique<Receiver>(*this->connection, subscription.channel, subscription.handler));
+    }
+    for(const auto& subscription : this->subscriptions) subscription.reset();
+}
+
+void NotificationListener::subscribe(const std::string& channel, handler_t handler, reset_t reset) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->subscriptions.push_back({channel, std::move(handler), std::move(reset)});
+    // picked up by the next poll
+    this->receivers.clear();
+    this->connection.reset();
+}
+
+bool NotificationListener::poll() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    try {
+        if(!this->connection || !this->connection->is_open()) this->reconnect();
+        this->connection->get_notifs();
+        return true;
+    }
+    catch(const std::exception& e) {
+        std::cerr << "notifications: " << e.what() << std::endl;
+        this->receivers.clear();
+        this->connection.reset();
+        return false;
+    }
+}
@@ -1,12 +1,84 @@
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <unistd.h>
 
+#include "../inc/server.h"
 #include "../inc/shell.h"
 
-int main() {
+static int usage() {
+    std::cerr << "usage: shell.out [--script <file>] [--user <name>] [--password <password>] [--transaction] [--pipeline] [--stats-file <file>] [--format text|csv|jsonl]\n"
+              << "       shell.out --listen <port|socket-path> [--workers n] [--async-connections n] [--stats-file <file>] [--format text|csv|jsonl]\n"
+              << "  commands are read from the script, or from stdin when it is not a terminal\n"
+              << "  credentials default to $AIRPORT_USER and $AIRPORT_PASSWORD in batch mode\n"
+              << "  --stats-file writes a latency histogram per command on exit\n"
+              << "  --format picks how list, depart, arrive, meals and mealTypes print their rows\n"
+              << "  --listen serves many sessions on a local port or unix socket, each starting with login <user> <password>,\n"
+              << "  on --workers threads, one per core by default\n"
+              << "  --async-connections sets how many pipelined connections per user run the read only commands\n"
+              << "  without a worker, 0 runs everything on the workers" << std::endl;
+    return 2;
+}
 
-    Shell app;
+int main(int argc, char** argv) {
 
-    // Launch console application
-    app.start();
+    std::string script;
+    std::string user = std::getenv("AIRPORT_USER") ? std::getenv("AIRPORT_USER") : "";
+    std::string password = std::getenv("AIRPORT_PASSWORD") ? std::getenv("AIRPORT_PASSWORD") : "";
+    bool transaction = false;
+    bool pipelined = false;
+    std::string statsFile;
+    std::string listen;
+    std::size_t workers = std::thread::hardware_concurrency();
+    std::size_t asyncConnections = 2;
 
-}
\ No newline at end of file
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(arg == "--script" && i + 1 < argc) script = argv[++i];
+        else if(arg == "--user" && i + 1 < argc) user = argv[++i];
+        else if(arg == "--password" && i + 1 < argc) password = argv[++i];
+        else if(arg == "--transaction") transaction = true;
+        else if(arg == "--pipeline") pipelined = true;
+        else if(arg == "--stats-file" && i + 1 < argc) statsFile = argv[++i];
+        else if(arg == "--listen" && i + 1 < argc) listen = argv[++i];
+        else if(arg == "--workers" && i + 1 < argc) workers = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--async-connections" && i + 1 < argc) asyncConnections = std::strtoul(argv[++i], nullptr, 10);
+        else if(arg == "--format" && i + 1 < argc) {
+            if(!TableWriter::parseFormat(argv[++i], TableWriter::format)) return usage();
+        }
+        else return usage();
+    }
+
+    if(!listen.empty()) {
+        Server server(listen, workers, asyncConnections);
+        std::signal(SIGINT, [](int) { Server::stop(); });
+        std::signal(SIGTERM, [](int) { Server::stop(); });
+        if(!server.run()) return 1;
+        if(!statsFile.empty() && !Stats::dump(statsFile)) std::cerr << "cannot write " << statsFile << std::endl;
+        return 0;
+    }
+
+    if(script.empty() && isatty(STDIN_FILENO)) {
+        Shell app;
+
+        // Launch console application
+        app.start();
+        if(!statsFile.empty() && !Stats::dump(statsFile)) std::cerr << "cannot write " << statsFile << std::endl;
+        return 0;
+    }
+
+    // batch mode, no prompts and every command goes over a single connection
+    if(user.empty()) return usage();
+    std::ifstream file;
+    if(!script.empty()) {
+        file.open(script);
+        if(!file) { std::cerr << "cannot open " << script << std::endl; return 2; }
+    }
+
+    Shell app(API(user, password, 1), script.empty() ? std::cin : file, transaction, pipelined);
+    int failures = app.start();
+    if(!statsFile.empty() && !Stats::dump(statsFile)) std::cerr << "cannot write " << statsFile << std::endl;
+    return failures == 0 ? 0 : 1;
+}
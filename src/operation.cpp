@@ -1,872 +1,853 @@
 #include "../inc/operation.h"
+#include "../inc/async.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
 
 // arguement validation
 
-std::string generate_random_string(int length) {
-    std::string str("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    std::uniform_int_distribution<> distr(0, str.size() - 1);
-    std::string random_string;
-    for (int n = 0; n < length; ++n)
-        random_string += str[distr(generator)];
-    return random_string;
-}
-static bool isValidBarcode(std::string barcode) {
-    const std::regex validBarcode("[a-zA-Z0-9]{12}");
-    return std::regex_match(barcode, validBarcode);
-}
-static std::string isDupBarcode(const API& api, std::string barcode) {
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    std::string dupBarcode = barcode;
-    while(true) {
-        connection.prepare( 
-            "DupBarcode",
-            "SELECT Passenger.barcode "
-            "FROM Passenger "
-            "WHERE passenger.barcode = $1 ; "
-        );
-        pqxx::result result1 = query.exec_prepared("DupBarcode", barcode);
-        if (result1.size() == 0) {
-            return dupBarcode;
-        }
-        else {
-            dupBarcode = generate_random_string(12);
-        }
-    }
-}
-static bool isValidFlightNum(const API& api, const std::string& flightNum) {
-    const std::regex validFlightNumber("[A-Z]{2}[0-9]{2,4}");
-    if (!std::regex_match(flightNum, validFlightNumber))
-        return false;
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    
-    connection.prepare("CheckDup",
-    "SELECT COUNT(*) "
-    "FROM Flight "
-    "JOIN StatusType ON (Flight.status_id = StatusType.id) "
-    "WHERE (StatusType.name NOT LIKE 'Arrived' "
-        "AND StatusType.name NOT LIKE 'Cancelled') "
-    "AND flight_number = $1 ; "
-    );
-    pqxx::result result1 = query.exec_prepared("CheckDup", flightNum);
-    return result1.at(0).at(0).as<int>() == 1;
-}
-static bool isNewFlight(const API& api, const std::string& flightNum) {
-    const std::regex validFlightNumber("[A-Z]{2}[0-9]{2,4}");
-    if (!std::regex_match(flightNum, validFlightNumber))
-        return false;
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    connection.prepare("CheckDup",
-    "SELECT COUNT(*) "
-    "FROM Flight "
-    "JOIN StatusType ON (Flight.status_id = StatusType.id) "
-    "WHERE (StatusType.name NOT LIKE 'Arrived' "
-        "AND StatusType.name NOT LIKE 'Cancelled') "
-    "AND flight_number = $1 ; "
-    );
-    pqxx::result result1 = query.exec_prepared("CheckDup", flightNum);
-    return result1.at(0).at(0).as<int>() == 0;
-}
-static bool isValidUpdateFlightnum(const std::string& flightNum) {
-    const std::regex validFlightNumber("[A-Z]{2}[0-9]{2,4}");
-    if (!std::regex_match(flightNum, validFlightNumber))
-        return false;
-    return true;
+// writes a result field to the table without copying it out of the result,
+// a pqxx::field or an AsyncResult::Field
+template<typename Field>
+static void put(TableWriter& table, const Field& value) {
+    if(value.is_null()) table.null();
+    else table.field(std::string_view(value.c_str(), value.size()));
 }
-static bool isValidDateTime(const std::string& dateTime) {
-    const std::regex validDateTime("[0-9]{4}-[0-9]{2}-[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2}");
-    return std::regex_match(dateTime, validDateTime);
+// the same for a numeric column, so csv and json lines get a number
+template<typename Field>
+static void putNumber(TableWriter& table, const Field& value) {
+    if(value.is_null()) table.null();
+    else table.number(std::string_view(value.c_str(), value.size()));
 }
-static bool isValidTime(const std::string& time) {
-    const std::regex validTime("^(?:[01][0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9](?:\\.[0-9]{1,3})?$");
-    return std::regex_match(time, validTime);
-}
-static bool isValidICAO(const std::string& icao) {
-    const std::regex validICAO("[A-Z]{4}");
-    return std::regex_match(icao, validICAO);
-}
-static bool isValidGate(const std::string& gate) {
-    const std::regex validGate("[A-Z][0-9]{1,2}");
-    return std::regex_match(gate, validGate);
-}
-static bool isValidAirplane(const std::string& airplane) {
-    const std::regex validAirplane("[a-zA-Z0-9 ]+");
-    return std::regex_match(airplane, validAirplane);
+
+// reference ids by name, reporting the name when the cache doesn't know it
+static bool statusId(const API& api, std::string_view name, int& id) {
+    if(api.reference().status(name, id)) return true;
+    Console::err() << "unknown status " << name << std::endl;
+    return false;
 }
-static bool isValidAirline(const std::string& airline) {
-    const std::regex validAirline("[a-zA-Z ]+");
-    return std::regex_match(airline, validAirline);
+static bool locationId(const API& api, std::string_view icao, int& id) {
+    if(api.reference().location(icao, id)) return true;
+    Console::err() << "unknown location " << icao << std::endl;
+    return false;
 }
 
-
-
-
-// command mappings
-
-// maps keyword to invoke command to its corresponding id
-const std::map<std::string, operation_t> Operation::commandList = {
-    {"exit", Operation::c_exit},
-    {"help", Operation::c_help},
-    {"status", Operation::c_status},
-    {"create", Operation::c_create},
-    {"depart", Operation::c_depart},
-    {"arrive", Operation::c_arrive},
-    {"passengers", Operation::c_passengers},
-    {"list", Operation::c_list},
-    {"delay", Operation::c_delay},
-    {"mealTypes", Operation::c_mealTypes},
-    {"meals", Operation::c_meals},
-    {"changeStatus", Operation::c_changeStatus},
-    {"addCargo", Operation::c_addCargo},
-    {"removeCargo", Operation::c_removeCargo},
-    {"checkCargo", Operation::c_checkCargo},
-    {"changeDestination", Operation::c_changeDestination},
-    {"changeOrigin", Operation::c_changeOrigin},
-};
-
-//maps keyword to its corresponding help message
-const std::map<std::string, std::string> Operation::commandHelp = {
-    {"exit", "exit - exits program"},
-    {"help", "help - lists all commands"},
-    {"status", "status <flight-number> - gets information about a flight"},
-    {"depart", "depart <icao> - lists flights leaving to <icao>"},
-    {"arrive", "arrive <icao> - lists flights leaving from <icao>"},
-    {"passengers", "passengers <flight-number> <+/-n> - adds (+) or subtracts (-) \'n\' passengers from the flight"},
-    {"list", "list - lists every active flight"},
-    {"delay", "delay <flight-number> <\"hh:mm:ss\"> - lists every active flight"},
-    {"meals", "meals <flight-number> - lists all the meals on a flight"},
-    {"mealTypes", "mealTypes <flight-number> - lists all the categories of meals on a flight"},
-    {"changeStatus", "changeStatus <flight-number> - updates the status of the flight "},
-    {"changeDestination", "changeDestination <flight-number> - changes the current destination to new destination"},
-    {"changeOrigin", "changeOrigin <flight-number> - changes the current Origin to new Origin"},
-    {"addCargo", "addCargo <flight-number> <cargo-weight> <cargo-barcode>- adds cargo to a flight"},
-    {"removeCargo", "removeCargo <flight-number> <cargo-barcode> - removes cargo from a flight"},
-    {"checkCargo", "checkCargo <flight-number> - checks total weight of cargo in a flight"},
-    {"create", "create <flight-number> <departure-time \"YYYY-MM-DD  HH:MM:SS\"> <arrival-time \"YYYY-MM-DD  HH:MM:SS\"> <gate> <airplane> <destination> <origin> <airline>  - creates a new flight put values in quotes"},
-};
+// statements that look the flight up themselves lead with its "active" column,
+// no rows means there is no such flight
+template<typename Result>
+static error_t checkFlight(const Result& rows) {
+    if(rows.empty()) return Error::NOTFOUND;
+    if(!rows[0][0].template as<bool>()) return Error::INACTIVE;
+    return Error::SUCCESS;
+}
 
 // command implementation
 
-error_t Operation::help() {
+error_t Operation::stats(const API& api) {
     // command has no args
-    for(auto& [cmd, id] : Operation::commandList) {
-        if(Operation::commandHelp.find(cmd) != Operation::commandHelp.end()) {
-            // help message exists for command
-            std::cout << Operation::commandHelp.at(cmd) << '\n';
-        }
-    }
+    Console::out() << "Statements prepared: " << Statement::prepareCount() << '\n';
+    Console::out() << "Statements executed: " << Statement::executeCount() << '\n';
+    Console::out() << "Flight cache hits: " << api.flights().hits() << ", misses: " << api.flights().misses() << '\n';
+    // average ms per call in each phase
+    Stats::print(Console::out());
+    Console::out().flush();
     return Error::SUCCESS;
 }
 
-error_t Operation::shell_exit() {
+error_t Operation::shell_exit(const API&) {
     return Error::EXIT;
 }
 
-error_t Operation::status(const API& api, const std::list<std::string>& args) {
-    // #TODO add rest of get plane info here:
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    std::string flightNum = args.front();
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    // flight number was specified and is valid
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    
-    // we could abstract this out; not sure
-    connection.prepare(
-    "get_flight",
-    "SELECT flight_number, departure_time, arrival_time, ( "
-    "select count(*) "
-    "from passenger "
-    "where passenger.flight_id = flight.id "
-        "and flight.id = (select id from flight where flight_number = $1 ) "
-    ") as num_passengers, letter as Terminal, gate_number, statustype.name as status, airplanetype.name as plane_type, airlinetype.name as airline, origin.icao as origin, destination.icao as destination "
-    "FROM flight "
-        "JOIN gatetype ON (flight.gate_id = gatetype.id) "
-        "JOIN terminaltype ON (gatetype.terminal_id = terminaltype.id) "
-        "JOIN statustype ON (flight.status_id = statustype.id) "
-        "JOIN airplanetype ON (flight.airplane_id = airplanetype.id) "
-        "JOIN airlinetype ON (flight.airline_id = airlinetype.id) "
-        "JOIN locationtype AS origin ON (flight.origin_id = origin.id) " 
-        "JOIN locationtype AS destination ON (flight.destination_id = destination.id) "
-        
-    "WHERE flight_number = $1 "
-        "AND ( "
-        "StatusType.name NOT LIKE 'Arrived'"
-           " AND StatusType.name NOT LIKE 'Cancelled' );"
-    );
-    // flight_number, departure_time, arrival_time, num_passengers, letter, gate_number, statustype.name, airplanetype.name, airlinetype.name, origin.icao, destination.icao
-    // 0              1               2             3               4       5            6                7                  8                 9            10
-    
-    pqxx::row rows;
-    try {
-        rows = query.exec_prepared1("get_flight", flightNum);
-    }
-    catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
-    }
-    
-    std::cout << "Flight " << rows[0] << " from " << rows[9] << " to " << rows[10] << " is " << rows[6] << '\n';
-    std::cout << "Expected departure at " << rows[1] << " and arrives at " << rows[2] << '\n';
-    std::cout << "Flight uses a(n) " << rows[7] << " with " << rows[8] << '\n';
-    std::cout << "Flight will use gate " << rows[4] << rows[5] << " and has " << rows[3] << " passengers." << std::endl;
-
+// active, flight_number, departure_time, arrival_time, num_passengers, letter, gate_number, statustype.name, airplanetype.name, airlinetype.name, origin.icao, destination.icao
+// 0       1              2               3             4               5       6            7                8                  9                 10           11
+static void printStatus(const snapshot_t& flight) {
+    Console::out() << "Flight " << flight[1] << " from " << flight[10] << " to " << flight[11] << " is " << flight[7] << '\n';
+    Console::out() << "Expected departure at " << flight[2] << " and arrives at " << flight[3] << '\n';
+    Console::out() << "Flight uses a(n) " << flight[8] << " with " << flight[9] << '\n';
+    Console::out() << "Flight will use gate " << flight[5] << flight[6] << " and has " << flight[4] << " passengers." << std::endl;
+}
+// one flight of several, a line in place of the status of one that can't be shown
+static void printStatus(std::string_view flightNum, error_t status, const snapshot_t& flight, bool first) {
+    if(!first) Console::out() << '\n';
+    if(status == Error::SUCCESS) printStatus(flight);
+    else Console::out() << "Flight " << flightNum << (status == Error::NOTFOUND ? " does not exist" : " has arrived or been cancelled") << std::endl;
+}
+// the first columns of get_flight and get_flights, the rest are left out
+template<typename Row>
+static snapshot_t snapshotOf(const Row& row, std::size_t columns = 12) {
+    snapshot_t flight;
+    flight.reserve(columns);
+    for(std::size_t i = 0; i < columns; ++i) flight.emplace_back(row[i].c_str(), row[i].size());
+    return flight;
+}
+// codes as a postgres array literal, they are alphanumeric so need no quoting
+template<typename Values>
+static std::string arrayOf(const Values& values) {
+    std::string out;
+    out.reserve(values.size() * (BarcodeGenerator::length + 1) + 2);
+    out += '{';
+    for(const auto& value : values) {
+        if(out.size() > 1) out += ',';
+        if constexpr(std::is_same_v<std::decay_t<decltype(value)>, std::string>) out += value;
+        else out += value.view();
+    }
+    out += '}';
+    return out;
+}
+template<typename Result>
+static error_t finishStatus(const Staged&, const Result& result) {
+    error_t found = checkFlight(result);
+    if(found != Error::SUCCESS) return found;
+    printStatus(snapshotOf(result[0]));
     return Error::SUCCESS;
-}   
-
-// Inside of args
-// args = {flight-number, departure, arrival, gate, airplane, destination(ICAO), origin(ICAO), airline}
-//
-error_t Operation::create(const API& api, const std::list<std::string>& args) {
-    // command has args
-
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    auto it = args.begin();
-    
-    std::string flightNum = *it;
-    if(!isNewFlight(api ,flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    std::string departure = *(++it);
-    std::string arrival = *(++it);
-    if(!isValidDateTime(departure) || !isValidDateTime(arrival)) { std::cerr << departure << " or " << arrival << "is incorrect" << std::endl; return Error::BADARGS;}
-    std::string gate = *(++it);
-    if(!isValidGate(gate)) { std::cerr << "invalid gate" << std::endl; return Error::BADARGS;}
-    std::string airplane = *(++it);
-    if(!isValidAirplane(airplane)) { std::cerr << "invalid airplane type" << std::endl; return Error::BADARGS;}
-    std::string destination = *(++it);
-    std::string origin = *(++it); 
-    if(!isValidICAO(destination) || !isValidICAO(origin)) {  std::cerr << "One of the locations is not valid" << std::endl; return Error::BADARGS;}
-    std::string airline = *(++it);
-    if(!isValidAirline(airline)) {std::cerr << "invalid airline" << std::endl; return Error::BADARGS;}
-    auto terminal = gate.substr(0, 1);
-    auto gateNum = gate.substr(1, gate.length()-1);
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare("CreateFlight",
-    "INSERT INTO Flight(id, flight_number, departure_time, arrival_time, gate_id, status_id, airplane_id, destination_id, origin_id, airline_id) "
-    "VALUES ((SELECT NEXTVAL('flight_id_seq')),"
-        "$1 , " 
-        "$2 , " 
-        "$3 , "
-        "(SELECT GateType.id FROM GateType " 
-            "JOIN TerminalType ON (TerminalType.id = GateType.terminal_id) "
-            "WHERE TerminalType.letter = $4 "
-                "AND GateType.gate_number = $5 ), "
-        "1, "
-        "(SELECT id FROM AirplaneType WHERE AirplaneType.name = $6 ), " 
-        "(SELECT id FROM LocationType WHERE LocationType.icao = $7 ), "
-        "(SELECT id FROM LocationType WHERE LocationType.icao = $8 ), "
-        "(SELECT id FROM AirlineType WHERE AirlineType.name = $9 ));  "
-    );
-
-    pqxx::result result;
-
-    try
-    {    
-        auto result = query.exec_prepared("CreateFlight", flightNum, departure, arrival, terminal, gateNum, airplane, destination, origin, airline);
-    }
-    catch(const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
+}
+// get_flights, a row per flight asked for with a null active column for
+// one that doesn't exist, the first status that isn't SUCCESS is returned
+template<typename Result>
+static error_t finishStatuses(const Staged&, const Result& rows) {
+    error_t result = Error::SUCCESS;
+    bool first = true;
+    for(auto it = rows.begin(); it != rows.end(); ++it) {
+        error_t status = it[0].is_null() ? Error::NOTFOUND : it[0].template as<bool>() ? Error::SUCCESS : Error::INACTIVE;
+        printStatus(std::string_view(it[12].c_str(), it[12].size()), status, status == Error::SUCCESS ? snapshotOf(it) : snapshot_t(), first);
+        if(result == Error::SUCCESS) result = status;
+        first = false;
     }
-    std::cout << "Flight " << flightNum << " created." << std::endl; 
-    query.commit();
-
-    return Error::SUCCESS;
+    return result;
+}
+static Staged stageStatus(const flights_t& flights) {
+    if(flights.size() == 1) return {"get_flight", {flights.front().str()}, finishStatus<pqxx::result>, false, finishStatus<AsyncResult>};
+    return {"get_flights", {arrayOf(flights)}, finishStatuses<pqxx::result>, false, finishStatuses<AsyncResult>};
+}
+// answered from the flight cache when it can be, the query result fills it
+// several flights take one query for all the ones that aren't cached
+error_t Operation::status(const API& api, const flights_t& flights) {
+    if(flights.size() == 1) {
+        Staged staged = stageStatus(flights);
+        if(Operation::answer(api, staged)) return Error::SUCCESS;
+        return Operation::execute(api, staged);
+    }
+
+    std::vector<FlightStatus> found;
+    error_t looked = Operation::lookup(api, flights, found);
+    if(looked != Error::SUCCESS) return looked;
+    error_t result = Error::SUCCESS;
+    for(std::size_t i = 0; i < found.size(); ++i) {
+        printStatus(found[i].flight.view(), found[i].status, found[i].snapshot, i == 0);
+        if(result == Error::SUCCESS) result = found[i].status;
+    }
+    return result;
 }
 
-error_t Operation::depart(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    std::string icao = args.front();
-    if(!isValidICAO(icao)) {  std::cerr << "not a valid locaiton" << std::endl; return Error::BADARGS; }
-
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-        "get_destinations",
-        "SELECT flight_number, destination.icao FROM flight "
-            "JOIN LocationType AS origin ON (flight.origin_id = origin.id) "
-            "JOIN LocationType AS destination ON (flight.destination_id = destination.id) "
-            "JOIN StatusType ON (flight.status_id = StatusType.id) "
-        "WHERE origin.icao = $1 "
-            "AND " 
-            "("
-                "StatusType.name NOT LIKE 'Arrived'"
-                    "AND StatusType.name NOT LIKE 'Cancelled'"
-            ")"
-        ";"
-    );
+error_t Operation::lookup(const API& api, const flights_t& flights, std::vector<FlightStatus>& found) {
+    found.clear();
+    found.reserve(flights.size());
+    // where each flight the cache didn't have is in found
+    std::vector<std::size_t> missing;
+    for(const auto& flight : flights) {
+        FlightStatus status {flight, Error::SUCCESS, {}};
+        unsigned long epoch;
+        if(!api.flights().find(flight, status.snapshot, epoch)) {
+            status.status = Error::NOTFOUND;
+            missing.push_back(found.size());
+        }
+        found.push_back(std::move(status));
+    }
+    if(missing.empty()) return Error::SUCCESS;
 
+    flights_t uncached;
+    for(std::size_t i : missing) uncached.push_back(found[i].flight);
+    unsigned long epoch = api.flights().epoch();
     pqxx::result rows;
-
     try
     {
-        rows = query.exec_prepared("get_destinations", icao);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        rows = Statement::exec(*query, connection, "get_flights", arrayOf(uncached));
+        Statement::commit(*query);
     }
-    catch(const std::exception& e)
+    catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
-    
-    for(auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout << "Flight " << it[0].as<std::string>() << " to " << it[1].as<std::string>() << '\n';
+
+    // one row per number asked for, in the same order
+    for(std::size_t i = 0; i < missing.size() && i < rows.size(); ++i) {
+        FlightStatus& status = found[missing[i]];
+        if(rows[i][0].is_null()) continue;
+        status.snapshot = snapshotOf(rows[i]);
+        status.status = rows[i][0].as<bool>() ? Error::SUCCESS : Error::INACTIVE;
+        if(status.status == Error::SUCCESS) api.flights().store(status.flight, status.snapshot, epoch);
     }
-    std::cout.flush();  
     return Error::SUCCESS;
 }
 
-error_t Operation::arrive(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    std::string icao = args.front();
-    if(!isValidICAO(icao)) { std::cerr << "not a valid locaiton" << std::endl; return Error::BADARGS; }
-
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-        "get_arrivals",
-        "SELECT flight_number, origin.icao FROM flight "
-            "JOIN LocationType AS origin ON (flight.origin_id = origin.id) "
-            "JOIN LocationType AS destination ON (flight.destination_id = destination.id) "
-            "JOIN StatusType ON (flight.status_id = StatusType.id) "
-        "WHERE destination.icao = $1"
-            "AND " 
-            "("
-                "StatusType.name NOT LIKE 'Arrived'"
-                    "AND StatusType.name NOT LIKE 'Cancelled'"
-            ")"
-        ";"
-    );
+// args = {flight-number, departure, arrival, gate, airplane, destination(ICAO), origin(ICAO), airline}
+error_t Operation::create(const API& api, FlightNumber flightNum, std::string_view departureTime, std::string_view arrivalTime, Gate gate,
+                          std::string_view airplane, ICAO destination, ICAO origin, std::string_view airline) {
+    std::string departure(departureTime), arrival(arrivalTime);
+    if(departure >= arrival) {Console::err() << "the flight has to depart before it arrives" << std::endl; return Error::BADARGS;}
+
+    // names are resolved from the reference cache so unknown ones never reach the database
+    int gateId, destinationId, originId, airlineId, home, standby, arrived, cancelled;
+    Airplane plane;
+    if(!api.reference().gate(gate.view(), gateId)) {Console::err() << "unknown gate " << gate << std::endl; return Error::BADARGS;}
+    if(!api.reference().airplane(airplane, plane)) {Console::err() << "unknown airplane type " << airplane << std::endl; return Error::BADARGS;}
+    if(!api.reference().airline(airline, airlineId)) {Console::err() << "unknown airline " << airline << std::endl; return Error::BADARGS;}
+    if(!locationId(api, destination.view(), destinationId) || !locationId(api, origin.view(), originId)) return Error::BADARGS;
+    if(!locationId(api, ReferenceCache::home, home)) return Error::DBERROR;
+    if(!statusId(api, "Standby", standby) || !statusId(api, "Arrived", arrived) || !statusId(api, "Cancelled", cancelled)) return Error::DBERROR;
+    if(originId == destinationId || (originId != home && destinationId != home)) {
+        Console::err() << "flights have to go between " << ReferenceCache::home << " and another airport" << std::endl; return Error::BADARGS;
+    }
+
+    pqxx::result result;
 
-    pqxx::result rows;
-    
     try
     {    
-        rows = query.exec_prepared("get_arrivals", icao);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        result = Statement::exec(*query, connection, "CreateFlight", flightNum, departure, arrival, gateId, standby, plane.id, destinationId, originId, airlineId, arrived, cancelled);
+        // nothing is inserted while an active flight holds the number
+        if(result.affected_rows() != 1) {Console::err() << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
+        Statement::commit(*query);
     }
-    catch (const std::exception& e)
+    catch(const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
+    Console::out() << "Flight " << flightNum << " created." << std::endl; 
 
-    for(auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout << "Flight " << it[0].as<std::string>() << " from " << it[1].as<std::string>() << '\n';
-    }
-    std::cout.flush();  
     return Error::SUCCESS;
 }
-// flight number , cargo weight, cargo barcode
-error_t Operation::addCargo(const API& api, const std::list<std::string>& args) {// todo redo with barcode and cargo weight
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    auto it = args.begin();
-    std::string flightNum = *(it);
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    std::string cargo = *(++it);
-    const std::regex validCargo("[0-9]+(\\.[0-9]+)?");
-    if (!std::regex_match(flightNum, validCargo)) {std::cerr << "invalid CargoWeight" << std::endl; return Error::BADARGS;}
-    std::string barcode = *(++it);
-    if(!isValidBarcode(barcode)) {std::cerr << "barcode: " << barcode << " is invalid" << std::endl; return Error::BADARGS;}
-    
-    // flight number was specified and is valid
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    
-    connection.prepare(
-        "add_cargo",
-        "INSERT INTO Cargo(id, flight_id, weight_lb, barcode)"
-        "VALUES ((SELECT NEXTVAL('cargo_id_seq')),"
-        "(SELECT id FROM Flight WHERE flight_number = $1),"
-        "$2, $3);"
-    );
-
-    pqxx::result rows; 
-    try
-    {    
-        rows = query.exec_prepared("add_cargo", flightNum, cargo, barcode);
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
-    }
 
-    for (auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout << it[0].as<std::string>() << '\n';
+template<typename Result>
+static error_t finishDepart(const Staged&, const Result& rows) {
+    TableWriter table(Console::out(), {{"Flight #", "flight", 10}, {"To", "destination", 8}});
+    table.header();
+    for(auto it = rows.begin(); it != rows.end(); ++it) {
+        put(table, it[0]);
+        put(table, it[1]);
+        table.endRow();
     }
-    std::cout.flush();
-    query.commit();
-    std::cout<<"Cargo added to flight "<<flightNum << " With the barcode "<< barcode << std::endl;
     return Error::SUCCESS;
 }
+static Staged stageDepart(ICAO icao) {
+    return {"get_destinations", {icao.str()}, finishDepart<pqxx::result>, false, finishDepart<AsyncResult>};
+}
+error_t Operation::depart(const API& api, ICAO icao) {
+    return Operation::execute(api, stageDepart(icao));
+}
 
-// Function: List all active flights in chronological order → returns list of flights in chronological order
-// args = {flight-number, departure, arrival, gate, airplane, destination(ICAO), origin(ICAO), airline}
-//
-error_t Operation::list(const API& api) {
-    // #TODO add rest of get plane info here:
-    /*
-    if(args.empty()) return Error::BADARGS;
-    std::string flightNum = args.front();
-    if(!isValidFlightNum(flightNum)) return Error::BADARGS;
-    */
-    
-    // flight number was specified and is valid
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    
-    connection.prepare(
-        "all_flights",
-        "SELECT flight_number, departure_time, arrival_time, GateType.gate_number, TerminalType.letter, " 
-        "StatusType.name, c1.name AS destination, c2.name AS origin, AirlineType.name "
-        "FROM Flight "
-            "JOIN StatusType ON (Flight.status_id = StatusType.id) "
-            "JOIN GateType ON (Flight.gate_id = GateType.id) "
-            "JOIN TerminalType ON (GateType.terminal_id = TerminalType.id) "
-            "JOIN LocationType dest ON (dest.id = Flight.destination_id) "
-            "JOIN LocationType origin ON (origin.id = Flight.origin_id) "
-            "JOIN CityType c1 ON (dest.city_id = c1.id ) "
-            "JOIN CityType c2 ON (origin.city_id = c2.id) "
-            "JOIN AirlineType ON (Flight.airline_id = AirlineType.id) "
-        "WHERE (StatusType.name NOT LIKE 'Arrived') "
-        "ORDER BY departure_time "
-        ";"
-    );
-    pqxx::result rows;
-    try
-    {    
-        rows = query.exec_prepared("all_flights");
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
-    }
-    
-    std::cout << std::right << std::setw(10) << "Flight #" 
-          << std::right << std::setw(24) << "Departure Time" 
-          << std::right << std::setw(24) << "Arrival Time" 
-          << std::right << std::setw(8) << "Gate" 
-          << std::right << std::setw(11) << "Terminal" 
-          << std::right << std::setw(14) << "Status" 
-          << std::right << std::setw(19) << "Destination" 
-          << std::right << std::setw(18) << "Origin" 
-          << std::right << std::setw(20) << "Airline" 
-          << '\n';
-
-    std::cout << "----------------------------------------------------------------------------------------------------------------------------------------------------\n";
-
-    
+template<typename Result>
+static error_t finishArrive(const Staged&, const Result& rows) {
+    TableWriter table(Console::out(), {{"Flight #", "flight", 10}, {"From", "origin", 8}});
+    table.header();
     for(auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout   << std::right << std::setw(10) << it[0].as<std::string>()
-                    << std::right << std::setw(24) << it[1].as<std::string>()
-                    << std::right << std::setw(24) << it[2].as<std::string>()
-                    << std::right << std::setw(8)  << it[3].as<std::string>()
-                    << std::right << std::setw(11) << it[4].as<std::string>() 
-                    << std::right << std::setw(14) << it[5].as<std::string>() 
-                    << std::right << std::setw(19) << it[6].as<std::string>() 
-                    << std::right << std::setw(18) << it[7].as<std::string>() 
-                    << std::right << std::setw(20) << it[8].as<std::string>() 
-                    << '\n';
-    }
-    std::cout.flush();  
+        put(table, it[0]);
+        put(table, it[1]);
+        table.endRow();
+    }
     return Error::SUCCESS;
-} 
-
-error_t Operation::delay(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-
-    auto it = args.begin();
-
-    std::string flightNum = *it;
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    std::string delay = *(++it);
-    if(!isValidTime(delay)) {std::cerr << "invalid delay"<< std::endl; return Error::BADARGS;}
+}
+static Staged stageArrive(ICAO icao) {
+    return {"get_arrivals", {icao.str()}, finishArrive<pqxx::result>, false, finishArrive<AsyncResult>};
+}
+error_t Operation::arrive(const API& api, ICAO icao) {
+    return Operation::execute(api, stageArrive(icao));
+}
+static error_t finishAddCargo(const Staged& staged, const pqxx::result& rows) {
+    // active, inserted, room left before the insert
+    error_t found = checkFlight(rows);
+    if(found != Error::SUCCESS) return found;
+    if(rows[0][1].as<int>() == 0) {
+        Console::out() << "Cargo weighs " << staged.params[1] << " lbs but flight " << staged.params[0]
+                  << " only has room for " << rows[0][2].as<std::string>() << " lbs" << std::endl;
+        return Error::FULL;
+    }
+    Console::out()<<"Cargo added to flight "<< staged.params[0] << " With the barcode "<< staged.params[2] << std::endl;
+    return Error::SUCCESS;
+}
+static Staged stageAddCargo(FlightNumber flightNum, std::string_view weight, Barcode barcode) {
+    return {"add_cargo", {flightNum.str(), std::string(weight), barcode.str()}, finishAddCargo, true};
+}
+// flight number , cargo weight, cargo barcode
+error_t Operation::addCargo(const API& api, FlightNumber flightNum, std::string_view weight, Barcode barcode) {
+    return Operation::execute(api, stageAddCargo(flightNum, weight, barcode));
+}
 
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
+// one manifest row, its weight kept as written for COPY and parsed once for
+// the room check
+struct Parcel {
+    std::string weight;
+    double pounds;
+    Barcode barcode;
+};
 
-    connection.prepare(
-        "delay_flight",
-        "UPDATE flight "
-        "SET " 
-           "departure_time = ((SELECT departure_time FROM flight WHERE flight_number = $1)::TIMESTAMP + $2), " 
-            "arrival_time = ((SELECT arrival_time FROM flight WHERE flight_number = $1)::TIMESTAMP + $2) "
-        "WHERE flight_number = $1"
-        ";"
-    );
+// reads <weight>,<barcode> rows, skipping blank lines, # comments and a header
+// line, and rejects the whole file if any row is malformed
+static bool readManifest(const std::string& path, std::vector<Parcel>& rows, double& total) {
+    std::ifstream file(path);
+    if(!file) {Console::err() << "cannot open " << path << std::endl; return false;}
+
+    bool valid = true;
+    std::string line;
+    for(unsigned long number = 1; std::getline(file, line); ++number) {
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.empty() || line.front() == '#') continue;
+        std::size_t comma = line.find(',');
+        std::string weight = line.substr(0, comma);
+        std::string_view text = comma == std::string::npos ? std::string_view() : std::string_view(line).substr(comma + 1);
+        if(number == 1 && weight == "weight") continue;
+        Barcode barcode;
+        bool parsed = Validate::weight(weight) && Barcode::parse(text, barcode);
+        // any number of digits passes the validator, too many overflow a double
+        errno = 0;
+        double pounds = parsed ? std::strtod(weight.c_str(), nullptr) : 0;
+        if(!parsed || errno == ERANGE || !std::isfinite(pounds)) {
+            Console::err() << path << ':' << number << ": invalid row" << std::endl;
+            valid = false;
+            continue;
+        }
+        rows.push_back({weight, pounds, barcode});
+        total += pounds;
+    }
+    return valid;
+}
 
-    pqxx::result result;
+// flight number, csv file
+// the rows are copied in with one COPY in one transaction after checking the
+// airplane's max_cargo once, rather than an insert per parcel
+// parcels are taken in file order, any that would overload the airplane are
+// left behind and listed while lighter ones after them still go on
+error_t Operation::loadCargo(const API& api, FlightNumber flightNum, std::string_view path) {
+    std::vector<Parcel> manifest;
+    double weight = 0;
+    if(!readManifest(std::string(path), manifest, weight)) return Error::BADARGS;
+    if(manifest.empty()) {Console::err() << "no cargo to load" << std::endl; return Error::BADARGS;}
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Parcel> loaded, left;
+    double loadedWeight = 0;
     try
     {
-        result = query.exec_prepared("delay_flight", flightNum, delay);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        // active, flight id, max_cargo, current cargo weight, the flight stays
+        // locked until commit so the room can't be taken in the meantime
+        pqxx::result rows = Statement::exec(*query, connection, "cargo_capacity", flightNum);
+        error_t found = checkFlight(rows);
+        if(found != Error::SUCCESS) return found;
+
+        int flightId = rows[0][1].as<int>();
+        double capacity = rows[0][2].as<double>() - rows[0][3].as<double>();
+        for(const auto& parcel : manifest) {
+            if(loadedWeight + parcel.pounds <= capacity) {
+                loaded.push_back(parcel);
+                loadedWeight += parcel.pounds;
+            }
+            else left.push_back(parcel);
+        }
+        if(loaded.empty()) {
+            Console::err() << "cargo weighs " << weight << " lbs but flight " << flightNum << " only has room for " << capacity << " lbs" << std::endl;
+            return Error::FULL;
+        }
+
+        {
+            Stats::Timer timer(Stats::execute);
+            pqxx::stream_to stream(*query, "cargo", std::vector<std::string>{"flight_id", "weight_lb", "barcode"});
+            for(const auto& parcel : loaded) {
+                stream << std::make_tuple(flightId, parcel.weight, parcel.barcode);
+            }
+            stream.complete();
+            Stats::roundTrip(0);
+        }
+        // COPY doesn't go through add_cargo, so the flight's total is summed again
+        Statement::exec(*query, connection, "recount_cargo", flightId);
+        Statement::commit(*query);
+        api.flights().invalidate(flightNum);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
 
-    if(result.affected_rows() != 1) return Error::DBERROR;  
-    query.commit();
+    std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+    unsigned long rate = took.count() > 0 ? static_cast<unsigned long>(loaded.size() * 1000 / took.count()) : 0;
+    Console::out() << "Loaded " << loaded.size() << " pieces of cargo (" << loadedWeight << " lbs) onto flight " << flightNum
+              << " in " << static_cast<unsigned long>(took.count()) << " ms, " << rate << " rows/sec" << std::endl;
+    if(left.empty()) return Error::SUCCESS;
 
-    std::cout << "Flight " << flightNum << " delayed by " << delay << std::endl;
-    return Error::SUCCESS;
+    Console::out() << left.size() << " piece(s) of cargo (" << weight - loadedWeight << " lbs) did not fit:" << '\n';
+    for(const auto& parcel : left) Console::out() << parcel.barcode << ' ' << parcel.weight << " lbs" << '\n';
+    Console::out().flush();
+    return Error::FULL;
 }
-//flight_num
-error_t Operation::meals(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) return Error::BADARGS;
-
-    std::string flightNum = args.front();
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-        "getMeals",
-        "SELECT MealType.name "
-        "FROM MealToFlight "
-            "JOIN MealType ON (MealToFlight.meal_id = MealType.id) "
-            "JOIN StatusType ON (StatusType.id = MealToFlight.flight_id) "
-        "WHERE MealToFlight.flight_id = (SELECT id FROM flight WHERE flight_number = $1) "
-            "AND " 
-            "("
-                "StatusType.name NOT LIKE 'Arrived'"
-                    "AND StatusType.name NOT LIKE 'Cancelled'"
-            ")"
-        "ORDER BY MealType.name"
-        ";"
-    );
 
-    pqxx::result rows;
+// Function: List all active flights in chronological order → returns list of flights in chronological order
+// args = [--limit n] [--offset n] [--since departure-time [--after flight-id]]
+// rows come through a server side cursor a batch at a time and are printed as
+// they arrive, so memory stays flat however many flights there are
+error_t Operation::list(const API& api, const Arg::Page::type& page) {
+    std::string limit(page.limit);
+
+    TableWriter table(Console::out(), {
+        {"Flight #", "flight", 10},
+        {"Departure Time", "departure", 24},
+        {"Arrival Time", "arrival", 24},
+        {"Gate", "gate", 8},
+        {"Terminal", "terminal", 11},
+        {"Status", "status", 14},
+        {"Destination", "destination", 19},
+        {"Origin", "origin", 18},
+        {"Airline", "airline", 20},
+    });
+    table.header();
+
+    std::size_t count = 0;
+    std::string last;
+    std::string lastId;
     try
     {
-        rows = query.exec_prepared("getMeals", flightNum);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        {
+            // cursors take plain sql, so the statement is expanded rather than prepared
+            pqxx::icursorstream cursor(*query, Statement::expand(*query, "all_flights", {std::string(page.since), std::string(page.after), limit, std::string(page.offset)}), "list", Operation::listBatch);
+            pqxx::result rows;
+            while(true) {
+                {
+                    Stats::Timer timer(Stats::execute);
+                    if(!(cursor >> rows)) break;
+                    Stats::roundTrip(rows.size());
+                }
+                for(auto it = rows.begin(); it != rows.end(); ++it) {
+                    for(int column = 0; column < 9; ++column) put(table, it[column]);
+                    table.endRow();
+                }
+                if(!rows.empty()) {
+                    last = rows[rows.size() - 1][1].as<std::string>();
+                    lastId = rows[rows.size() - 1][9].as<std::string>();
+                }
+                count += rows.size();
+                // each batch is shown as soon as it arrives
+                table.flush();
+            }
+        }
+        Statement::commit(*query);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
 
-    for (auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout << it[0].as<std::string>() << '\n';
+    // a full page probably isn't the end, say how to get the next one, on
+    // stderr when the output is meant for another program
+    if(limit != "0" && count == std::stoul(limit)) {
+        (TableWriter::format == TableWriter::text ? Console::out() : Console::err()) << "next page: list --limit " << limit << " --since \"" << last << "\" --after " << lastId << std::endl;
     }
-    std::cout.flush();
     return Error::SUCCESS;
+} 
 
-}
-// flightnum and cargo 
-error_t Operation::checkCargo(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    auto it = args.begin();
-    std::string flightNum = *(it);
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    
-    // flight number was specified and is valid
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    
-    connection.prepare(
-        "check_cargo",
-        "SELECT SUM(weight_lb) FROM Cargo "
-        "WHERE flight_id = (SELECT id FROM Flight WHERE flight_number = $1)"
-        ";"
-    );
+static error_t finishDelay(const Staged& staged, const pqxx::result& result) {
+    error_t found = checkFlight(result);
+    if(found != Error::SUCCESS) return found;
+    if(result[0][1].as<int>() != 1) return Error::DBERROR;
 
-    pqxx::result rows;
-    try
-    {
-        rows = query.exec_prepared("check_cargo", flightNum);
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
-    }
-        std::cout << "Cargo weight: " << rows[0][0].as<std::string>() << " lbs" << std::endl;
-        std::cout.flush();
+    Console::out() << "Flight " << staged.params[0] << " delayed by " << staged.params[1] << std::endl;
     return Error::SUCCESS;
 }
-error_t Operation::mealTypes(const API& api, const std::list<std::string>& args) {
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    std::string flightNum = args.front();
-    //checks for valid flight number and if its a duplicate
-    if(!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS; }
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-    "CheckMealType",
-    "SELECT Distinct MealCategoryType.category "
-    "FROM MealCategoryType "
-        "JOIN MealToCategory ON (MealCategoryType.id = MealToCategory.category_id) "
-        "JOIN MealType ON (MealToCategory.meal_id = MealType.id) "
-        "JOIN MealToFlight ON (MealType.id = MealToFlight.meal_id) "
-    "WHERE MealToFlight.flight_id = (SELECT Flight.id FROM Flight WHERE Flight.flight_number = $1) "
-    "ORDER BY MealCategoryType.category; "
-    );
-
-    pqxx::result rows;
-    try
-    {
-        rows = query.exec_prepared("CheckMealType", flightNum);
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return Error::DBERROR;
-    }
-    query.commit();
+static Staged stageDelay(FlightNumber flightNum, std::string_view delay) {
+    return {"delay_flight", {flightNum.str(), std::string(delay)}, finishDelay, true};
+}
+error_t Operation::delay(const API& api, FlightNumber flightNum, std::string_view delay) {
+    return Operation::execute(api, stageDelay(flightNum, delay));
+}
+template<typename Result>
+static error_t finishMeals(const Staged&, const Result& rows) {
+    error_t found = checkFlight(rows);
+    if(found != Error::SUCCESS) return found;
 
+    // a flight without meals comes back as a single row with a null name
+    TableWriter table(Console::out(), {{"Meal", "meal", 0}});
     for (auto it = rows.begin(); it != rows.end(); ++it) {
-        std::cout << it[0].as<std::string>() << '\n';
+        if(it[1].is_null()) continue;
+        put(table, it[1]);
+        table.endRow();
     }
     return Error::SUCCESS;
 }
-
-// flightnum
-error_t Operation::passengers(const API& api, const std::list<std::string>& args) { //TODO MAKE SURE THIS WORKS
-    if(args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    auto it = args.begin();
-    std::string flightNum = *(it);
-    if (!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    std::string barcode = generate_random_string(12);
-    barcode = isDupBarcode(api, barcode);
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    connection.prepare(
-        "add_passenger",
-        "INSERT INTO Passenger (id, flight_id, barcode) " 
-        "VALUES ((SELECT NEXTVAL('passenger_id_seq')), (SELECT id FROM Flight WHERE flight_number = $1 ), $2);"
-    ); 
-    pqxx::result rows = query.exec_prepared("add_passenger", flightNum, barcode);
-    query.commit();
-    std::cout << "Passenger for the flight: "+ flightNum+ " has been added with the barcode: "+barcode << std::endl;
+static Staged stageMeals(FlightNumber flightNum) {
+    return {"getMeals", {flightNum.str()}, finishMeals<pqxx::result>, false, finishMeals<AsyncResult>};
+}
+//flight_num
+error_t Operation::meals(const API& api, FlightNumber flightNum) {
+    return Operation::execute(api, stageMeals(flightNum));
+}
+template<typename Result>
+static error_t finishCheckCargo(const Staged&, const Result& rows) {
+    error_t found = checkFlight(rows);
+    if(found != Error::SUCCESS) return found;
+    Console::out() << "Cargo weight: " << rows[0][1].template as<std::string>() << " lbs" << std::endl;
     return Error::SUCCESS;
 }
+static Staged stageCheckCargo(FlightNumber flightNum) {
+    return {"check_cargo", {flightNum.str()}, finishCheckCargo<pqxx::result>, false, finishCheckCargo<AsyncResult>};
+}
+// flightnum and cargo 
+error_t Operation::checkCargo(const API& api, FlightNumber flightNum) {
+    return Operation::execute(api, stageCheckCargo(flightNum));
+}
+template<typename Result>
+static error_t finishMealTypes(const Staged&, const Result& rows) {
+    error_t found = checkFlight(rows);
+    if(found != Error::SUCCESS) return found;
 
+    TableWriter table(Console::out(), {{"Category", "category", 0}});
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        if(it[1].is_null()) continue;
+        put(table, it[1]);
+        table.endRow();
+    }
+    return Error::SUCCESS;
+}
+static Staged stageMealTypes(FlightNumber flightNum) {
+    return {"CheckMealType", {flightNum.str()}, finishMealTypes<pqxx::result>, false, finishMealTypes<AsyncResult>};
+}
+error_t Operation::mealTypes(const API& api, FlightNumber flightNum) {
+    return Operation::execute(api, stageMealTypes(flightNum));
+}
 
-error_t Operation::changeStatus(const API& api, const std::list<std::string>& args) {
-    if (args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-
-    auto it = args.begin();
+// each statement's rows are one per passenger, or a single null one when
+// there were none, after the flight's active column
+static std::vector<std::string> barcodes(const pqxx::result& rows) {
+    std::vector<std::string> out;
+    for(const auto& row : rows) {
+        if(!row[1].is_null()) out.push_back(row[1].as<std::string>());
+    }
+    return out;
+}
 
-    std::string flightNum = *(it);
-    if (!isValidUpdateFlightnum(flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    
-    std::string newStatus = *(++it);
-    if (!std::regex_match(newStatus, std::regex("(Standby|Boarding|Departed|Delayed|In Transit|Arrived|Cancelled)"))) {std::cerr << "Invalid Status" << std::endl; return Error::BADARGS;}
-    
-    std::cout << "Flight number: " << flightNum << std::endl;
-    std::cout << "New status: " << newStatus << std::endl;
-    
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-        "update_status",
-        "UPDATE Flight "
-        "SET status_id = (SELECT id FROM StatusType WHERE name = $1) "
-        "WHERE flight_number = $2; "
-    );
-
-    connection.prepare(
-        "get_status",
-        "SELECT StatusType.name FROM Flight "
-            "JOIN StatusType ON (Flight.status_id = StatusType.id)  "
-        "WHERE flight_number = $1; "
-    );
+// flight number, +n to board n passengers or -n to remove the n most recent
+// boarding is one set based insert that stops at the airplane's seats, topped
+// up in the rare case a generated barcode was already taken
+error_t Operation::passengers(const API& api, FlightNumber flightNum, int change) {
+    bool removing = change < 0;
+    int count = removing ? -change : change;
 
-    pqxx::result rows;
+    std::vector<std::string> changed;
+    bool full = false;
     try
     {
-        rows = query.exec_prepared("update_status", newStatus, flightNum);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        if(removing) {
+            pqxx::result rows = Statement::exec(*query, connection, "remove_passengers", flightNum, count);
+            error_t found = checkFlight(rows);
+            if(found != Error::SUCCESS) return found;
+            changed = barcodes(rows);
+        }
+        else {
+            for(int attempt = 0; attempt < 3 && !full && static_cast<int>(changed.size()) < count; ++attempt) {
+                std::vector<std::string> generated = BarcodeGenerator::batch(count - changed.size());
+                pqxx::result rows = Statement::exec(*query, connection, "add_passengers", flightNum, arrayOf(generated));
+                error_t found = checkFlight(rows);
+                if(found != Error::SUCCESS) return found;
+                std::vector<std::string> added = barcodes(rows);
+                changed.insert(changed.end(), added.begin(), added.end());
+                // seats left before this insert, asking for more means the rest didn't fit
+                full = rows[0][2].as<long>() < static_cast<long>(generated.size());
+            }
+            if(!full && static_cast<int>(changed.size()) < count) {
+                Console::err() << "could not generate unique barcodes" << std::endl;
+                return Error::DBERROR;
+            }
+        }
+        Statement::commit(*query);
+        api.flights().invalidate(flightNum);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
 
-    query.commit();
+    Console::out() << changed.size() << " passenger(s) " << (removing ? "removed from" : "added to") << " the flight: " << flightNum << '\n';
+    for(const auto& barcode : changed) Console::out() << barcode << '\n';
+    if(full) Console::out() << count - changed.size() << " passenger(s) not boarded, the flight is full" << '\n';
+    Console::out().flush();
+    return full ? Error::FULL : Error::SUCCESS;
+}
+
+
+error_t Operation::changeStatus(const API& api, FlightNumber flightNum, std::string_view newStatus) {
+    int statusNum;
+    if (!statusId(api, newStatus, statusNum)) return Error::BADARGS;
+    
+    Console::out() << "Flight number: " << flightNum << std::endl;
+    Console::out() << "New status: " << newStatus << std::endl;
 
+    pqxx::result rows;
     try
-    {    
-        rows = query.exec_prepared("get_status", flightNum);
+    {
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        rows = Statement::exec(*query, connection, "update_status", flightNum, statusNum);
+        Statement::commit(*query);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
-    
-    for(auto it = rows.begin(); it != rows.end(); ++it) {
-         std::cout << "Flight now has a status " << it[0].as<std::string>() << std::endl;
-    }
+    error_t found = checkFlight(rows);
+    if (found != Error::SUCCESS) return found;
+    api.flights().invalidate(flightNum);
 
+    Console::out() << "Flight now has a status " << rows[0][1].as<std::string>() << std::endl;
     return Error::SUCCESS;
 }
-// args {flightNum, barcode}
-error_t Operation::removeCargo(const API& api, const std::list<std::string>& args) {
-    if (args.empty()){ std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
-    auto it = args.begin();
-    std::string flightNum = *(it);
-    if (!isValidFlightNum(api, flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    std::string barcode = *(++it);
-    if (!isValidBarcode(barcode)) {std::cerr << "barcode: " << barcode << " is invalid" << std::endl; return Error::BADARGS;}
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-    connection.prepare(
-        "remove_cargo",
-        "DELETE FROM Cargo "
-        "WHERE flight_id = (SELECT id FROM Flight WHERE flight_number = $1) "
-            "AND barcode = $2; "
-    );
-    pqxx::result rows = query.exec_prepared("remove_cargo", flightNum, barcode);
-    query.commit();
-    if (rows.affected_rows() == 0) {
-        std::cout << "Cargo with barcode: " << barcode << " does not exist on flight: " << flightNum << std::endl;
+static error_t finishRemoveCargo(const Staged& staged, const pqxx::result& rows) {
+    error_t found = checkFlight(rows);
+    if (found != Error::SUCCESS) return found;
+    if (rows[0][1].as<int>() == 0) {
+        Console::out() << "Cargo with barcode: " << staged.params[1] << " does not exist on flight: " << staged.params[0] << std::endl;
         return Error::BADARGS;
     }
-    std::cout << "Cargo with barcode: " << barcode << " has been removed from flight: " << flightNum << std::endl;
+    Console::out() << "Cargo with barcode: " << staged.params[1] << " has been removed from flight: " << staged.params[0] << std::endl;
     return Error::SUCCESS;
-
+}
+static Staged stageRemoveCargo(FlightNumber flightNum, Barcode barcode) {
+    return {"remove_cargo", {flightNum.str(), barcode.str()}, finishRemoveCargo, true};
+}
+// args {flightNum, barcode}
+error_t Operation::removeCargo(const API& api, FlightNumber flightNum, Barcode barcode) {
+    return Operation::execute(api, stageRemoveCargo(flightNum, barcode));
 }
 
 // Set destination: Update the destination
 //          Edge 1: Can't be cancelled, arrived, or in the air
 //          Edge 2: The origin needs to be our airport 
 //          
-error_t Operation::changeDestination(const API& api, const std::list<std::string>& args) {
-    if (args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
+error_t Operation::changeDestination(const API& api, FlightNumber flightNum, ICAO newDestination) {
+    if (newDestination == ReferenceCache::home) {Console::err() << "the flight already leaves from " << ReferenceCache::home << std::endl; return Error::BADARGS;}
 
-    auto it = args.begin();
+    int destinationId, home, standby, delayed;
+    if (!locationId(api, newDestination.view(), destinationId)) return Error::BADARGS;
+    if (!locationId(api, ReferenceCache::home, home) || !statusId(api, "Standby", standby) || !statusId(api, "Delayed", delayed)) return Error::DBERROR;
 
-    std::string flightNum = *(it);
-    if (!isValidUpdateFlightnum(flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl; return Error::BADARGS;}
-    
-    std::string newDestination = *(++it);
-    if (!isValidICAO(newDestination)) {std::cerr << "not a valid locaiton" << std::endl;  return Error::BADARGS;}
-
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
-
-    connection.prepare(
-        "update_destination",
-        "UPDATE Flight "
-        "SET destination_id =   (SELECT LocationType.id "
-                                "FROM LocationType "
-                                    "JOIN CityType ON (CityType.id = LocationType.city_id) "
-                                "WHERE LocationType.icao = $1 AND LocationType.icao NOT LIKE 'KDTW') "
-        "WHERE flight_number = $2 "
-        "AND (status_id = 4 OR status_id = 1) "
-        "AND origin_id = 1; "
-                                                                          
-    );
-    connection.prepare(
-        "get_destination",
-        "SELECT CityType.name FROM Flight "
-            "JOIN LocationType ON (Flight.destination_id = LocationType.id)  "
-            "JOIN CityType ON (LocationType.city_id = CityType.id)  "
-        "WHERE flight_number = $1; "
-    );
     pqxx::result rows;
     try
     {
-        rows = query.exec_prepared("update_destination", newDestination, flightNum);
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        rows = Statement::exec(*query, connection, "update_destination", flightNum, destinationId, standby, delayed, home);
+        Statement::commit(*query);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
+    error_t found = checkFlight(rows);
+    if (found != Error::SUCCESS) return found;
+    if (rows[0][1].is_null()) {
+        Console::err() << "only a Standby or Delayed flight leaving " << ReferenceCache::home << " can change its destination" << std::endl;
+        return Error::BADARGS;
+    }
+    api.flights().invalidate(flightNum);
 
-    query.commit();
+    Console::out() << "The new destination for the flight <" << flightNum << "> is " << rows[0][1].as<std::string>() << std::endl;
+    return Error::SUCCESS;
+}
 
-    
+// Set origin: Update the origin
+//          Edge 1: Can't be cancelled, arrived, or in the air
+//          Edge 2: The destination needs to be our airport 
+//   
+error_t Operation::changeOrigin(const API &api, FlightNumber flightNum, ICAO newOrigin) {
+    if (newOrigin == ReferenceCache::home) {Console::err() << "the flight already arrives at " << ReferenceCache::home << std::endl; return Error::BADARGS;}
+
+    int originId, home, standby, delayed;
+    if (!locationId(api, newOrigin.view(), originId)) return Error::BADARGS;
+    if (!locationId(api, ReferenceCache::home, home) || !statusId(api, "Standby", standby) || !statusId(api, "Delayed", delayed)) return Error::DBERROR;
+
+    pqxx::result rows;
+    try {
+         PooledConnection connection = api.begin();
+         std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+         rows = Statement::exec(*query, connection, "update_origin", flightNum, originId, standby, delayed, home);
+         Statement::commit(*query);
+    } catch (const std::exception &e) {
+         Console::err() << e.what() << std::endl;
+         return Error::DBERROR;
+    }
+    error_t found = checkFlight(rows);
+    if (found != Error::SUCCESS) return found;
+    if (rows[0][1].is_null()) {
+        Console::err() << "only a Standby or Delayed flight arriving at " << ReferenceCache::home << " can change its origin" << std::endl;
+        return Error::BADARGS;
+    }
+    api.flights().invalidate(flightNum);
+
+    Console::out() << "The new origin for the flight <" << flightNum << "> is " << rows[0][1].as<std::string>() << std::endl;
+    return Error::SUCCESS;
+}
+// recompute every flight's passenger_count and cargo_weight_total from its
+// rows, only reporting the ones that are off unless asked to repair them
+error_t Operation::recount(const API& api, bool repair) {
+    TableWriter table(Console::out(), {
+        {"Flight #", "flight", 10},
+        {"Passengers", "passenger_count", 12},
+        {"Counted", "passengers", 10},
+        {"Cargo lbs", "cargo_weight_total", 14},
+        {"Weighed", "cargo", 14},
+    });
+    pqxx::result rows;
     try
-    {    
-        rows = query.exec_prepared("get_destination", flightNum);
+    {
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        // writers would change the rows while they are counted
+        if(repair) {
+            Stats::Timer timer(Stats::execute);
+            query->exec("LOCK TABLE Passenger, Cargo IN SHARE MODE");
+            Stats::roundTrip(0);
+        }
+        rows = Statement::exec(*query, connection, "recount", repair);
+        Statement::commit(*query);
     }
     catch (const std::exception& e)
     {
-        std::cerr << e.what() << std::endl;
+        Console::err() << e.what() << std::endl;
         return Error::DBERROR;
     }
-    for(auto it = rows.begin(); it != rows.end(); ++it) {
-         std::cout << "The new destination for the flight <" << flightNum << "> is " << it[0].as<std::string>() << std::endl;
-    }
 
+    table.header();
+    for(auto it = rows.begin(); it != rows.end(); ++it) {
+        put(table, it[0]);
+        for(int column = 1; column < 5; ++column) putNumber(table, it[column]);
+        table.endRow();
+        if(!repair) continue;
+        // numbers the cache can't key on are dropped with everything else
+        FlightNumber flight;
+        if(FlightNumber::parse(std::string_view(it[0].c_str(), it[0].size()), flight)) api.flights().invalidate(flight);
+        else api.flights().clear();
+    }
+    table.flush();
+    (TableWriter::format == TableWriter::text ? Console::out() : Console::err())
+        << rows.size() << " flight(s) " << (repair ? "repaired" : "out of step") << std::endl;
     return Error::SUCCESS;
 }
 
-// Set origin: Update the origin
-//          Edge 1: Can't be cancelled, arrived, or in the air
-//          Edge 2: The destination needs to be our airport 
-//   
-error_t Operation::changeOrigin(const API &api, const std::list<std::string> &args) {
-    if (args.empty()) {std::cerr << "empty arguments"<< std::endl; return Error::BADARGS;}
+// staged execution
 
-    auto it = args.begin();
+error_t Operation::execute(const API& api, const Staged& staged) {
+    unsigned long epoch = api.flights().epoch();
 
-    std::string flightNum = *(it);
-    if (!isValidUpdateFlightnum(flightNum)) {std::cerr << "Flight " << flightNum << " already exists." << std::endl;  return Error::BADARGS;}
+    pqxx::result rows;
+    try
+    {
+        PooledConnection connection = api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        rows = Statement::execParams(*query, connection, staged.statement, staged.params);
+        // reads commit too so a batch savepoint is released rather than rolled back
+        Statement::commit(*query);
+    }
+    catch (const std::exception& e)
+    {
+        Console::err() << e.what() << std::endl;
+        return Error::DBERROR;
+    }
+    return Operation::finish(api, staged, rows, epoch);
+}
 
-    std::string newOrigin = *(++it);
-    if (!isValidICAO(newOrigin)) return Error::BADARGS;
+// the flight a staged command is about, its first parameter
+static FlightNumber flightOf(const Staged& staged) {
+    FlightNumber flight;
+    FlightNumber::parse(staged.params[0], flight);
+    return flight;
+}
 
-    pqxx::connection connection = api.begin();
-    pqxx::work query(connection);
+// shared by both kinds of result, handle is the staged function for that kind
+template<typename Result>
+static error_t finishWith(const API& api, const Staged& staged, error_t (*handle)(const Staged&, const Result&), const Result& rows, unsigned long epoch) {
+    error_t status = handle(staged, rows);
+    if(staged.writes) api.flights().invalidate(flightOf(staged));
+    else if(handle == finishStatus<Result> && status == Error::SUCCESS) api.flights().store(flightOf(staged), snapshotOf(rows[0]), epoch);
+    else if(handle == finishStatuses<Result>) {
+        for(auto it = rows.begin(); it != rows.end(); ++it) {
+            FlightNumber flight;
+            if(it[0].is_null() || !it[0].template as<bool>() || !FlightNumber::parse(std::string_view(it[12].c_str(), it[12].size()), flight)) continue;
+            api.flights().store(flight, snapshotOf(it), epoch);
+        }
+    }
+    return status;
+}
 
-    connection.prepare(
-        "update_origin",
-        "UPDATE Flight "
-        "SET origin_id =   (SELECT LocationType.id "
-                            "FROM LocationType "
-                                "JOIN CityType ON (CityType.id = LocationType.city_id) "
-                            "WHERE LocationType.icao = $1 AND LocationType.icao NOT LIKE 'KDTW') "
-        "WHERE flight_number = $2 "
-        "AND destination_id = 1 "
-        "AND (status_id = 4 OR status_id = 1) "
+error_t Operation::finish(const API& api, const Staged& staged, const pqxx::result& rows, unsigned long epoch) {
+    return finishWith(api, staged, staged.finish, rows, epoch);
+}
 
-    );
+error_t Operation::finish(const API& api, const Staged& staged, const AsyncResult& rows, unsigned long epoch) {
+    return finishWith(api, staged, staged.async, rows, epoch);
+}
 
-    connection.prepare(
-        "get_origin",
-        "SELECT CityType.name FROM Flight "
-        "JOIN LocationType ON (Flight.origin_id = LocationType.id)  "
-        "JOIN CityType ON (LocationType.city_id = CityType.id)  "
-        "WHERE flight_number = $1; ");
+bool Operation::answer(const API& api, const Staged& staged) {
+    if(staged.finish != finishStatus<pqxx::result>) return false;
+    snapshot_t flight;
+    unsigned long epoch;
+    if(!api.flights().find(flightOf(staged), flight, epoch)) return false;
+    printStatus(flight);
+    return true;
+}
 
-    pqxx::result rows;
-    try {
-         rows = query.exec_prepared("update_origin", newOrigin, flightNum);
-    } catch (const std::exception &e) {
-         std::cerr << e.what() << std::endl;
-         return Error::DBERROR;
-    }
+// command registry
+
+// each command's arguments are declared once here, help shows them from the
+// same declaration and a line is parsed into them before any handler runs
+static constexpr CommandSpec commands[] = {
+    Schema<>::command<Operation::shell_exit>("exit", "exits program"),
+    Schema<>::command<Operation::help>("help", "lists all commands"),
+    Schema<>::command<Operation::stats>("stats", "shows statement counts and where each command's time went"),
+    Schema<Arg::FlightNumbers>::staged<Operation::status, stageStatus>("status", "gets information about one or more flights, in the order given", true),
+    Schema<Arg::ICAO>::staged<Operation::depart, stageDepart>("depart", "lists flights leaving to <icao>", true),
+    Schema<Arg::ICAO>::staged<Operation::arrive, stageArrive>("arrive", "lists flights leaving from <icao>", true),
+    Schema<Arg::FlightNumber, Arg::Change>::command<Operation::passengers>("passengers", "adds (+) or subtracts (-) 'n' passengers from the flight"),
+    Schema<Arg::Page>::command<Operation::list>("list", "lists flights that haven't arrived by departure, --since and --after continue after a departure time and flight id"),
+    Schema<Arg::FlightNumber, Arg::Duration>::staged<Operation::delay, stageDelay>("delay", "delays a flight's departure and arrival"),
+    Schema<Arg::FlightNumber>::staged<Operation::meals, stageMeals>("meals", "lists all the meals on a flight", true),
+    Schema<Arg::FlightNumber>::staged<Operation::mealTypes, stageMealTypes>("mealTypes", "lists all the categories of meals on a flight", true),
+    Schema<Arg::FlightNumber, Arg::Status>::command<Operation::changeStatus>("changeStatus", "updates the status of the flight"),
+    Schema<Arg::FlightNumber, Arg::ICAO>::command<Operation::changeDestination>("changeDestination", "changes the current destination to <icao>"),
+    Schema<Arg::FlightNumber, Arg::ICAO>::command<Operation::changeOrigin>("changeOrigin", "changes the current origin to <icao>"),
+    Schema<Arg::FlightNumber, Arg::Weight, Arg::Barcode>::staged<Operation::addCargo, stageAddCargo>("addCargo", "adds cargo to a flight"),
+    Schema<Arg::FlightNumber, Arg::Barcode>::staged<Operation::removeCargo, stageRemoveCargo>("removeCargo", "removes cargo from a flight"),
+    Schema<Arg::FlightNumber>::staged<Operation::checkCargo, stageCheckCargo>("checkCargo", "checks total weight of cargo in a flight", true),
+    Schema<Arg::FlightNumber, Arg::Path>::command<Operation::loadCargo>("loadCargo", "loads every <weight>,<barcode> line of a csv file onto a flight, listing any that don't fit"),
+    Schema<Arg::Repair>::command<Operation::recount>("recount", "lists flights whose passenger count or cargo weight is out of step, --repair corrects them"),
+    Schema<Arg::FlightNumber, Arg::Timestamp, Arg::Timestamp, Arg::Gate, Arg::Airplane, Arg::ICAO, Arg::ICAO, Arg::Airline>::command<Operation::create>(
+        "create", "creates a new flight, the times are departure then arrival and the locations destination then origin, put values with spaces in quotes"),
+};
 
-    query.commit();
+static constexpr PerfectHash<std::size(commands)> commandTable(commands);
+static_assert(commandTable.found(), "no seed gives every command its own slot, raise the slot count");
 
-    try {
-         rows = query.exec_prepared("get_origin", flightNum);
-    } catch (const std::exception &e) {
-         std::cerr << e.what() << std::endl;
-         return Error::DBERROR;
-    }
+const CommandSpec* Operation::find(std::string_view name) {
+    return commandTable.find(commands, name);
+}
 
-    for (auto it = rows.begin(); it != rows.end(); ++it) {
-          std::cout << "The new origin for the flight <" << flightNum << "> is " << it[0].as<std::string>() << std::endl;
+error_t Operation::help(const API&) {
+    for(const auto& command : commands) {
+        Console::out() << command.name << command.usage() << " - " << command.description << '\n';
     }
-
     return Error::SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,83 @@
+#include "../inc/pipeline.h"
+
+const std::size_t Pipeline::window = 64;
+
+Pipeline::Pipeline(const API& api) : api(api) {}
+
+bool Pipeline::accepts(const Command& c) {
+    // only asks whether the command can be staged, its arguments are checked on flush
+    const CommandSpec* command = Operation::find(c.getCommand());
+    return command != nullptr && command->stage != nullptr;
+}
+
+void Pipeline::push(const Command& c) {
+    this->commands.push_back(c);
+}
+
+std::size_t Pipeline::size() const {
+    return this->commands.size();
+}
+
+const std::vector<Command>& Pipeline::queued() const {
+    return this->commands;
+}
+
+std::vector<error_t> Pipeline::flush() {
+    std::size_t n = this->commands.size();
+    std::vector<Staged> staged(n);
+    std::vector<error_t> status(n);
+    std::vector<pqxx::result> results(n);
+
+    for(std::size_t i = 0; i < n; ++i) {
+        const Command& c = this->commands[i];
+        status[i] = Operation::find(c.getCommand())->stage(c.getArgs(), staged[i]);
+    }
+    this->commands.clear();
+
+    unsigned long epoch = this->api.flights().epoch();
+    // the window runs as one transaction, if any statement fails all of it is
+    // rolled back and replayed command by command to get each one's status
+    try {
+        PooledConnection connection = this->api.begin();
+        std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+        {
+            Stats::Timer timer(Stats::execute);
+            pqxx::pipeline pipe(*query);
+            pipe.retain(static_cast<int>(n));
+
+            std::vector<pqxx::pipeline::query_id> ids(n);
+            for(std::size_t i = 0; i < n; ++i) {
+                if(status[i] != Error::SUCCESS) continue;
+                ids[i] = pipe.insert(Statement::expand(*query, staged[i].statement, staged[i].params));
+            }
+            for(std::size_t i = 0; i < n; ++i) {
+                if(status[i] != Error::SUCCESS) continue;
+                results[i] = pipe.retrieve(ids[i]);
+            }
+            pipe.complete();
+            // the whole window goes out in one round trip
+            std::size_t rows = 0;
+            for(const auto& result : results) rows += result.size();
+            Stats::roundTrip(rows);
+        }
+        Statement::commit(*query);
+    }
+    catch(const std::exception&) {
+        return this->replay(staged, status);
+    }
+
+    // results are only handled once the window has committed
+    for(std::size_t i = 0; i < n; ++i) {
+        if(status[i] != Error::SUCCESS) continue;
+        status[i] = Operation::finish(this->api, staged[i], results[i], epoch);
+    }
+    return status;
+}
+
+std::vector<error_t> Pipeline::replay(const std::vector<Staged>& staged, std::vector<error_t>& status) {
+    for(std::size_t i = 0; i < staged.size(); ++i) {
+        if(status[i] != Error::SUCCESS) continue;
+        status[i] = Operation::execute(this->api, staged[i]);
+    }
+    return status;
+}
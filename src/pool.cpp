@@ -0,0 +1,144 @@
+#include "../inc/pool.h"
+
+const std::chrono::seconds ConnectionPool::healthInterval(30);
+const std::chrono::seconds ConnectionPool::waitTimeout(5);
+
+// pooled connection handle
+
+PooledConnection::PooledConnection(std::shared_ptr<ConnectionPool> pool, std::unique_ptr<PoolSlot> slot)
+: pool(std::move(pool)), slot(std::move(slot)) {}
+
+PooledConnection::PooledConnection(PooledConnection&& other)
+: pool(std::move(other.pool)), slot(std::move(other.slot)) {}
+
+PooledConnection::~PooledConnection() {
+    if(this->slot) this->pool->release(std::move(this->slot));
+}
+
+pqxx::connection& PooledConnection::operator*() const {
+    return *this->slot->connection;
+}
+
+pqxx::connection* PooledConnection::operator->() const {
+    return this->slot->connection.get();
+}
+
+std::set<std::string>& PooledConnection::preparedNames() {
+    return this->slot->prepared;
+}
+
+std::unique_ptr<pqxx::dbtransaction> PooledConnection::transaction() {
+    // BEGIN or SAVEPOINT is a round trip of its own
+    Stats::Timer timer(Stats::execute);
+    Stats::roundTrip(0);
+    if(this->slot->outer) return std::make_unique<pqxx::subtransaction>(*this->slot->outer);
+    return std::make_unique<pqxx::work>(*this->slot->connection);
+}
+
+void PooledConnection::beginOuter() {
+    this->slot->outer = std::make_unique<pqxx::work>(*this->slot->connection, "batch");
+}
+
+void PooledConnection::endOuter(bool commit) {
+    if(!this->slot->outer) return;
+    if(commit) this->slot->outer->commit();
+    else this->slot->outer->abort();
+    this->slot->outer.reset();
+}
+
+// pool
+
+ConnectionPool::ConnectionPool(const std::string& connectionString, std::size_t capacity)
+: connectionString(connectionString), capacity(capacity), open(0) {}
+
+std::size_t ConnectionPool::size() const {
+    return this->capacity;
+}
+
+std::unique_ptr<PoolSlot> ConnectionPool::connect() const {
+    auto slot = std::make_unique<PoolSlot>();
+    slot->connection = std::make_unique<pqxx::connection>(this->connectionString);
+    Stats::roundTrip(0);
+    slot->lastUsed = std::chrono::steady_clock::now();
+    return slot;
+}
+
+bool ConnectionPool::isHealthy(const PoolSlot& slot) const {
+    if(!slot.connection || !slot.connection->is_open()) return false;
+    // can't ping around an open transaction, a failure will surface in the next command
+    if(slot.outer) return true;
+    // recently used connections are trusted, anything older gets a round trip
+    if(std::chrono::steady_clock::now() - slot.lastUsed < healthInterval) return true;
+    try {
+        pqxx::nontransaction ping(*slot.connection);
+        ping.exec("SELECT 1;");
+        Stats::roundTrip(0);
+    }
+    catch(const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+PooledConnection ConnectionPool::acquire() {
+    // waiting, health checks and reconnecting all count as connection setup
+    Stats::Timer timer(Stats::connect);
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    while(this->idle.empty() && this->open >= this->capacity) {
+        if(this->available.wait_for(lock, waitTimeout) == std::cv_status::timeout
+            && this->idle.empty() && this->open >= this->capacity) {
+            throw std::runtime_error("connection pool exhausted");
+        }
+    }
+
+    std::unique_ptr<PoolSlot> slot;
+    if(!this->idle.empty()) {
+        // most recently returned first, it is the least likely to have gone stale
+        slot = std::move(this->idle.back());
+        this->idle.pop_back();
+    }
+    else {
+        ++this->open;
+    }
+    lock.unlock();
+
+    if(slot && slot->outer && !this->isHealthy(*slot)) {
+        // reconnecting would silently leave the batch transaction behind
+        this->discard();
+        throw pqxx::broken_connection("connection lost during batch transaction");
+    }
+    if(!slot || !this->isHealthy(*slot)) {
+        // new slot or dead connection, (re)connect outside of the lock
+        try {
+            slot = this->connect();
+        }
+        catch(...) {
+            this->discard();
+            throw;
+        }
+    }
+    return PooledConnection(this->shared_from_this(), std::move(slot));
+}
+
+void ConnectionPool::release(std::unique_ptr<PoolSlot> slot) {
+    if(!slot->connection->is_open()) {
+        // broken connections are dropped, the next acquire reconnects
+        this->discard();
+        return;
+    }
+    slot->lastUsed = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->idle.push_back(std::move(slot));
+    }
+    this->available.notify_one();
+}
+
+void ConnectionPool::discard() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        --this->open;
+    }
+    this->available.notify_one();
+}
@@ -0,0 +1,105 @@
+#include "../inc/reference.h"
+
+#include <iostream>
+
+const std::string ReferenceCache::channel = "reference_changed";
+const std::string ReferenceCache::home = "KDTW";
+
+ReferenceCache::ReferenceCache(std::shared_ptr<ConnectionPool> pool, std::shared_ptr<NotificationListener> listener)
+: pool(std::move(pool)), listener(std::move(listener)), stale(true), loaded(false), matched(true) {
+    this->listener->subscribe(ReferenceCache::channel,
+        [this](const std::string&) { this->stale = true; },
+        [this]() { this->stale = true; });
+}
+
+void ReferenceCache::load() {
+    std::map<std::string, int, std::less<>> locations, statuses, gates, airlines;
+    std::map<std::string, Airplane, std::less<>> airplanes;
+
+    PooledConnection connection = this->pool->acquire();
+    std::unique_ptr<pqxx::dbtransaction> query = connection.transaction();
+    for(const auto& row : query->exec("SELECT icao, id FROM LocationType")) {
+        locations.emplace(row[0].as<std::string>(), row[1].as<int>());
+    }
+    for(const auto& row : query->exec("SELECT name, id FROM StatusType")) {
+        statuses.emplace(row[0].as<std::string>(), row[1].as<int>());
+    }
+    for(const auto& row : query->exec(
+            "SELECT TerminalType.letter || GateType.gate_number, GateType.id FROM GateType "
+            "JOIN TerminalType ON (TerminalType.id = GateType.terminal_id)")) {
+        gates.emplace(row[0].as<std::string>(), row[1].as<int>());
+    }
+    for(const auto& row : query->exec("SELECT name, id FROM AirlineType")) {
+        airlines.emplace(row[0].as<std::string>(), row[1].as<int>());
+    }
+    for(const auto& row : query->exec("SELECT name, id, max_cargo, max_passengers FROM AirplaneType")) {
+        airplanes.emplace(row[0].as<std::string>(), Airplane{row[1].as<int>(), row[2].as<double>(), row[3].as<int>()});
+    }
+    query->commit();
+
+    this->locations.swap(locations);
+    this->statuses.swap(statuses);
+    this->gates.swap(gates);
+    this->airlines.swap(airlines);
+    this->airplanes.swap(airplanes);
+    this->loaded = true;
+
+    auto arrived = this->statuses.find("Arrived");
+    auto cancelled = this->statuses.find("Cancelled");
+    this->matched = arrived != this->statuses.end() && arrived->second == ReferenceCache::arrived
+                 && cancelled != this->statuses.end() && cancelled->second == ReferenceCache::cancelled;
+    if(!this->matched) {
+        std::cerr << "StatusType has to give Arrived id " << ReferenceCache::arrived << " and Cancelled id " << ReferenceCache::cancelled
+                  << ", list, depart and arrive would return the wrong flights" << std::endl;
+    }
+}
+
+// reloads when a change was announced, on failure the old tables are kept and
+// it tries again on the next lookup
+void ReferenceCache::refresh() {
+    if(!this->stale && this->loaded) return;
+    try {
+        this->stale = false;
+        this->load();
+    }
+    catch(const std::exception& e) {
+        std::cerr << "reference tables: " << e.what() << std::endl;
+        this->stale = true;
+    }
+}
+
+bool ReferenceCache::find(const std::map<std::string, int, std::less<>>& table, std::string_view name, int& id) {
+    this->listener->poll();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->refresh();
+    auto found = table.find(name);
+    if(found == table.end()) return false;
+    id = found->second;
+    return true;
+}
+
+bool ReferenceCache::location(std::string_view icao, int& id) { return this->find(this->locations, icao, id); }
+bool ReferenceCache::status(std::string_view name, int& id) { return this->find(this->statuses, name, id); }
+bool ReferenceCache::gate(std::string_view gate, int& id) { return this->find(this->gates, gate, id); }
+bool ReferenceCache::airline(std::string_view name, int& id) { return this->find(this->airlines, name, id); }
+
+bool ReferenceCache::airplane(std::string_view name, Airplane& airplane) {
+    this->listener->poll();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->refresh();
+    auto found = this->airplanes.find(name);
+    if(found == this->airplanes.end()) return false;
+    airplane = found->second;
+    return true;
+}
+
+bool ReferenceCache::warm() {
+    this->listener->poll();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->refresh();
+    return this->matched;
+}
+
+void ReferenceCache::invalidate() {
+    this->stale = true;
+}
@@ -0,0 +1,426 @@
+#include "../inc/server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const std::size_t Server::maxLine = 64 * 1024;
+const std::size_t Server::maxOutput = 16 * 1024 * 1024;
+
+static bool isPort(const std::string& address) {
+    return !address.empty() && std::all_of(address.begin(), address.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+std::atomic<bool> Server::stopping(false);
+
+Server::Session::Session(int socket) : socket(socket) {}
+
+Server::Session::~Session() {
+    ::close(this->socket);
+}
+
+Server::Server(std::string address, std::size_t workers, std::size_t asyncConnections)
+: address(std::move(address)), workerCount(std::max<std::size_t>(workers, 1)),
+  asyncConnections(asyncConnections), listener(-1), wakeRead(-1), wakeWrite(-1) {}
+
+Server::~Server() {
+    if(this->wakeRead >= 0) ::close(this->wakeRead);
+    if(this->wakeWrite >= 0) ::close(this->wakeWrite);
+    if(this->listener < 0) return;
+    ::close(this->listener);
+    if(!isPort(this->address)) ::unlink(this->address.c_str());
+}
+
+void Server::stop() {
+    Server::stopping = true;
+}
+
+// a port number listens on the loopback interface only, anything else is a
+// unix socket path
+bool Server::listen() {
+    bool tcp = isPort(this->address);
+    this->listener = ::socket(tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    if(this->listener < 0) {std::cerr << "socket: " << std::strerror(errno) << std::endl; return false;}
+
+    int bound;
+    if(tcp) {
+        int reuse = 1;
+        ::setsockopt(this->listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local {};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        local.sin_port = htons(static_cast<uint16_t>(std::stoul(this->address)));
+        bound = ::bind(this->listener, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+    }
+    else {
+        sockaddr_un local {};
+        local.sun_family = AF_UNIX;
+        if(this->address.size() >= sizeof(local.sun_path)) {std::cerr << "socket path too long" << std::endl; return false;}
+        std::strcpy(local.sun_path, this->address.c_str());
+        // left behind by a server that didn't shut down cleanly
+        ::unlink(local.sun_path);
+        bound = ::bind(this->listener, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+    }
+    if(bound < 0 || ::listen(this->listener, SOMAXCONN) < 0) {
+        std::cerr << this->address << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int wake[2];
+    if(::pipe(wake) < 0) {std::cerr << "pipe: " << std::strerror(errno) << std::endl; return false;}
+    this->wakeRead = wake[0];
+    this->wakeWrite = wake[1];
+    ::fcntl(this->wakeRead, F_SETFL, O_NONBLOCK);
+    ::fcntl(this->wakeWrite, F_SETFL, O_NONBLOCK);
+    return true;
+}
+
+bool Server::run() {
+    if(!this->listen()) return false;
+    std::cerr << "listening on " << this->address << " with " << this->workerCount << " workers" << std::endl;
+
+    std::vector<std::thread> workers;
+    for(std::size_t i = 0; i < this->workerCount; ++i) workers.emplace_back(&Server::work, this);
+
+    // sessions by socket, only this thread touches the map
+    std::map<int, std::shared_ptr<Session>> sessions;
+    std::vector<pollfd> watched;
+    while(!Server::stopping) {
+        watched.clear();
+        watched.push_back({this->listener, POLLIN, 0});
+        watched.push_back({this->wakeRead, POLLIN, 0});
+        for(const auto& [socket, session] : sessions) {
+            std::lock_guard<std::mutex> lock(session->writing);
+            watched.push_back({socket, static_cast<short>(POLLIN | (session->output.empty() ? 0 : POLLOUT)), 0});
+        }
+        std::size_t sessionEnd = watched.size();
+        for(const auto& [api, executor] : this->executors) executor->watch(watched);
+
+        // wakes up now and then to notice stop()
+        if(::poll(watched.data(), watched.size(), 250) < 0) {
+            if(errno == EINTR) continue;
+            std::cerr << "poll: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        if(watched[0].revents & POLLIN) this->accept(sessions);
+        if(watched[1].revents & POLLIN) {
+            char drained[64];
+            while(::read(this->wakeRead, drained, sizeof(drained)) > 0) {}
+        }
+        for(const auto& [api, executor] : this->executors) executor->process();
+        for(std::size_t i = 2; i < sessionEnd; ++i) {
+            if(watched[i].revents == 0) continue;
+            auto found = sessions.find(watched[i].fd);
+            if(found == sessions.end()) continue;
+            if(watched[i].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(found->second->writing);
+                Server::flush(*found->second);
+            }
+            if(!(watched[i].revents & ~POLLOUT) || this->receive(found->second)) continue;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                found->second->closed = true;
+            }
+            // a worker may still hold it, the socket closes with the last reference
+            sessions.erase(found);
+        }
+
+        // finishing one asynchronous command can make the next one ready at once
+        while(true) {
+            std::vector<std::shared_ptr<Session>> ready;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                ready.swap(this->resumed);
+            }
+            if(ready.empty()) break;
+            for(const auto& session : ready) this->schedule(session);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        Server::stopping = true;
+    }
+    this->ready.notify_all();
+    for(auto& worker : workers) worker.join();
+    // commands already sent to the database still get their replies
+    for(const auto& [api, executor] : this->executors) {
+        if(executor->pending() == 0) continue;
+        std::cerr << "finishing " << executor->pending() << " asynchronous command(s)" << std::endl;
+        executor->drain();
+    }
+    this->executors.clear();
+    return true;
+}
+
+void Server::accept(std::map<int, std::shared_ptr<Session>>& sessions) {
+    int socket = ::accept(this->listener, nullptr, nullptr);
+    if(socket < 0) return;
+    ::fcntl(socket, F_SETFL, ::fcntl(socket, F_GETFL) | O_NONBLOCK);
+    sessions.emplace(socket, std::make_shared<Session>(socket));
+}
+
+// queues every complete line, false once the client hung up or misbehaved
+bool Server::receive(const std::shared_ptr<Session>& session) {
+    char buffer[4096];
+    ssize_t count = ::recv(session->socket, buffer, sizeof(buffer), 0);
+    if(count <= 0) return count < 0 && (errno == EINTR || errno == EAGAIN);
+
+    session->partial.append(buffer, count);
+    std::vector<std::string> lines;
+    std::size_t start = 0;
+    for(std::size_t end; (end = session->partial.find('\n', start)) != std::string::npos; start = end + 1) {
+        std::string line = session->partial.substr(start, end - start);
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(std::move(line));
+    }
+    session->partial.erase(0, start);
+    if(session->partial.size() > Server::maxLine) return false;
+    if(lines.empty()) return true;
+
+    bool idle = false;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for(auto& line : lines) session->lines.push_back(std::move(line));
+        idle = !session->busy;
+        session->busy = true;
+    }
+    if(idle) this->schedule(session);
+    return true;
+}
+
+// hands a busy session's next line to the executor when it can run
+// asynchronously and to the workers otherwise, on the reading thread
+void Server::schedule(const std::shared_ptr<Session>& session) {
+    std::string line;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if(session->closed || session->lines.empty()) {
+            session->lines.clear();
+            session->busy = false;
+            return;
+        }
+        Command command(session->lines.front());
+        const CommandSpec* found = Operation::find(command.getCommand());
+        bool async = this->asyncConnections > 0 && session->api && found != nullptr && AsyncExecutor::accepts(*found);
+        if(!async) {
+            this->runnable.push_back(session);
+            this->ready.notify_one();
+            return;
+        }
+        line = std::move(session->lines.front());
+        session->lines.pop_front();
+    }
+    this->submit(session, line);
+}
+
+void Server::submit(const std::shared_ptr<Session>& session, const std::string& line) {
+    Command command(line);
+    unsigned long number = ++session->lineNumber;
+    std::string name(command.getCommand());
+    auto before = std::chrono::steady_clock::now();
+    this->executor(session->api).submit(*Operation::find(name), command.getArgs(),
+        [this, session, number, name, before](error_t status, const std::string& output) {
+            std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - before;
+            // no phases to split it into, the loop was doing other work meanwhile
+            Stats::begin();
+            Stats::end(name, took.count());
+            this->respond(*session, output, number, name, status, took.count());
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->resumed.push_back(session);
+        });
+}
+
+AsyncExecutor& Server::executor(const std::shared_ptr<API>& api) {
+    auto& executor = this->executors[api.get()];
+    if(!executor) executor = std::make_unique<AsyncExecutor>(*api, this->asyncConnections);
+    return *executor;
+}
+
+// runs one line of a session at a time, then hands the session back to the
+// reading thread, whose schedule() puts it at the back of the queue so a busy
+// client can't starve the others, or sends its next line asynchronously
+void Server::work() {
+    while(true) {
+        std::shared_ptr<Session> session;
+        std::string line;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->ready.wait(lock, [this] { return Server::stopping || !this->runnable.empty(); });
+            if(Server::stopping) return;
+            session = this->runnable.front();
+            this->runnable.pop_front();
+            if(session->closed) {
+                session->lines.clear();
+                session->busy = false;
+                continue;
+            }
+            line = std::move(session->lines.front());
+            session->lines.pop_front();
+        }
+
+        this->handle(*session, line);
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            more = !session->closed && !session->lines.empty();
+            if(more) this->resumed.push_back(session);
+            else session->busy = false;
+        }
+        if(more) this->wake();
+    }
+}
+
+// runs a line and sends back its output followed by one status line
+void Server::handle(Session& session, const std::string& line) {
+    Command command(line);
+    ++session.lineNumber;
+    // blank lines and # comments get no reply
+    if(command.getCommand().empty() || command.getCommand().front() == '#') return;
+
+    std::ostringstream reply;
+    error_t status = Error::SUCCESS;
+    double ms = 0;
+
+    if(command.getCommand() == "exit") {
+        status = Error::EXIT;
+    }
+    else if(command.getCommand() == "login") {
+        const args_t& args = command.getArgs();
+        std::string failure = "usage: login <user> <password>";
+        std::shared_ptr<API> api = args.size() == 2 ? this->login(std::string(args[0]), std::string(args[1]), failure) : nullptr;
+        if(api) session.api = api;
+        else {
+            reply << failure << '\n';
+            status = Error::BADARGS;
+        }
+    }
+    else if(Operation::find(command.getCommand()) == nullptr) {
+        status = Error::BADCMD;
+    }
+    else if(Operation::find(command.getCommand())->files) {
+        // the path would be opened on the server, not the client's machine
+        reply << command.getCommand() << " reads files and only runs in the shell" << '\n';
+        status = Error::BADCMD;
+    }
+    else if(!session.api) {
+        reply << "login <user> <password> first" << '\n';
+        status = Error::BADARGS;
+    }
+    else {
+        Stats::begin();
+        auto before = std::chrono::steady_clock::now();
+        {
+            Console::Redirect redirect(reply);
+            // an exhausted pool or a lost database fails the command, not the server
+            try {
+                status = Shell::dispatch(*session.api, command);
+            }
+            catch(const std::exception& e) {
+                Console::err() << e.what() << std::endl;
+                status = Error::DBERROR;
+            }
+        }
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - before;
+        ms = took.count();
+        if(status != Error::EXIT) Stats::end(command.getCommand(), ms);
+    }
+
+    if(status == Error::EXIT) {
+        // the reading thread sees the hang up once bye is sent and drops the session
+        this->send(session, "bye\n", true);
+        return;
+    }
+    this->respond(session, reply.str(), session.lineNumber, command.getCommand(), status, ms);
+}
+
+// a command's output followed by its status line
+void Server::respond(Session& session, std::string output, unsigned long number, std::string_view command, error_t status, double ms) {
+    std::ostringstream line;
+    line << '[' << number << "] " << command << ": " << Shell::describe(status)
+         << ' ' << std::fixed << std::setprecision(3) << ms << " ms" << '\n';
+    output += line.str();
+    this->send(session, output);
+}
+
+// reuses the API of an earlier session with the same credentials, a new one
+// is only kept once it has connected
+std::shared_ptr<API> Server::login(const std::string& user, const std::string& password, std::string& failure) {
+    std::string key = user + '\0' + password;
+    {
+        std::lock_guard<std::mutex> lock(this->logins);
+        auto found = this->apis.find(key);
+        if(found != this->apis.end()) return found->second;
+    }
+
+    auto api = std::make_shared<API>(user, password, this->workerCount);
+    try {
+        PooledConnection connection = api->begin();
+    }
+    catch(const std::exception& e) {
+        failure = "login failed";
+        std::cerr << "login " << user << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+    if(!api->reference().warm()) {
+        failure = "login failed, the database's status ids don't match the server's";
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->logins);
+    return this->apis.emplace(key, api).first->second;
+}
+
+// sends what the socket takes now and leaves the rest for the reading thread,
+// last shuts the socket once everything has gone
+void Server::send(Session& session, std::string_view data, bool last) {
+    bool waiting;
+    {
+        std::lock_guard<std::mutex> lock(session.writing);
+        session.output += data;
+        session.hangup = session.hangup || last;
+        waiting = !Server::flush(session);
+    }
+    // the reading thread only asks for POLLOUT when it rebuilds its list
+    if(waiting) this->wake();
+}
+
+// writes as much output as the socket takes without blocking, true once none
+// is left, called with the session's writing lock held
+// a failed send means the client is gone, the reading thread will notice
+bool Server::flush(Session& session) {
+    std::size_t sent = 0;
+    while(sent < session.output.size()) {
+        ssize_t count = ::send(session.socket, session.output.data() + sent, session.output.size() - sent, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR) continue;
+        if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if(count <= 0) {sent = session.output.size(); break;}
+        sent += count;
+    }
+    session.output.erase(0, sent);
+    // a client that stopped reading is dropped rather than buffered forever
+    if(session.output.size() > Server::maxOutput) {
+        session.output.clear();
+        session.hangup = true;
+    }
+    if(session.output.empty() && session.hangup) ::shutdown(session.socket, SHUT_RDWR);
+    return session.output.empty();
+}
+
+void Server::wake() {
+    char byte = 0;
+    // a full pipe already has the reading thread awake
+    if(::write(this->wakeWrite, &byte, 1) < 0) return;
+}
@@ -1,68 +1,136 @@
 #include "../inc/shell.h"
 
-Shell::Shell() : running(true), api(login()) {}
+Shell::Shell()
+: running(true), api(login()), input(std::cin), interactive(true), transaction(false),
+  pipelined(false), lineNumber(0), failures(0) {}
+
+Shell::Shell(const API& api, std::istream& input, bool transaction, bool pipelined)
+: running(true), api(api), input(input), interactive(false), transaction(transaction),
+  pipelined(pipelined), lineNumber(0), failures(0) {}
+
+// runs commands until exit or the end of input, returns how many failed
+int Shell::start() {
+    auto started = std::chrono::steady_clock::now();
+    // names are resolved client side from here on
+    if(!this->api.reference().warm()) return 1;
+    if(this->transaction) this->api.beginTransaction();
+    Pipeline pipeline(this->api);
 
-void Shell::start() {
     while(this->running) {
         Command cmd = fetchCommand();
+
+        // queued commands run in order before anything that cannot be pipelined
+        if(this->pipelined && Pipeline::accepts(cmd)) {
+            pipeline.push(cmd);
+            if(pipeline.size() >= Pipeline::window) this->flush(pipeline);
+            continue;
+        }
+        if(pipeline.size() > 0) this->flush(pipeline);
+
+        Stats::begin();
+        auto before = std::chrono::steady_clock::now();
         error_t status = executeCommand(cmd);
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - before;
 
         if(status == Error::EXIT) {
             this->running = false;
             continue;
         }
-        if(status == Error::BADARGS) {
-            std::cerr << "Bad Arguments" << std::endl;
+        Stats::end(cmd.getCommand(), took.count());
+        if(status != Error::SUCCESS) ++this->failures;
+        if(!this->interactive) {
+            this->report(cmd, status, took.count());
             continue;
         }
-        if( status == Error::DBERROR) {
-            std::cerr << "Database Error" << std::endl;
-            continue;
+        if(status != Error::SUCCESS) std::cerr << describe(status) << std::endl;
+    }
+
+    if(!this->interactive) {
+        std::cout.flush();
+        if(this->transaction) {
+            // a failed command only rolled back its own savepoint, the rest still commit
+            try {
+                this->api.endTransaction(true);
+            }
+            catch(const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                ++this->failures;
+            }
         }
-        if(status != Error::SUCCESS) std::cerr << status; //keep this at the bottom
+        std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - started;
+        std::cerr << this->lineNumber << " lines, " << this->failures << " failed, "
+                  << std::fixed << std::setprecision(3) << total.count() << " ms total" << std::endl;
+    }
+    return this->failures;
+}
+
+const char* Shell::describe(error_t status) {
+    switch(status) {
+    case Error::SUCCESS : return "ok";
+    case Error::BADARGS : return "Bad Arguments";
+    case Error::BADCMD : return "Invalid Command";
+    case Error::DBERROR : return "Database Error";
+    case Error::NOTFOUND : return "Flight Not Found";
+    case Error::INACTIVE : return "Flight Not Active";
+    case Error::FULL : return "Flight Full";
+    default : return "Unknown Error";
     }
 }
 
+// runs the queued commands and reports each one, the window's time is split evenly
+void Shell::flush(Pipeline& pipeline) {
+    std::vector<Command> commands = pipeline.queued();
+    Stats::begin();
+    auto before = std::chrono::steady_clock::now();
+    std::vector<error_t> statuses = pipeline.flush();
+    std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - before;
+    // a window can't be split between its commands, it is recorded as a whole
+    Stats::end("pipeline", took.count());
+
+    for(std::size_t i = 0; i < commands.size(); ++i) {
+        if(statuses[i] != Error::SUCCESS) ++this->failures;
+        this->report(commands[i], statuses[i], took.count() / commands.size());
+    }
+}
+
+// one line per command on stderr so it never mixes into command output
+void Shell::report(const Command& cmd, error_t status, double ms) {
+    std::cout.flush();
+    std::cerr << '[' << this->lineNumber << "] " << cmd.getCommand() << ": " << describe(status)
+              << ' ' << std::fixed << std::setprecision(3) << ms << " ms" << std::endl;
+}
+
 Command Shell::fetchCommand() {
 
     bool validCommand = false;
 
     while(!validCommand) {
         std::string input;
-        std::cout << "air>";
-        std::cout.flush();
-        std::getline(std::cin, input);
+        if(this->interactive) {
+            std::cout << "air>";
+            std::cout.flush();
+        }
+        // end of input behaves like exit
+        if(!std::getline(this->input, input)) return Command("exit");
+        ++this->lineNumber;
 
-        std::stringstream ss(input);
+        // the command keeps the line, its tokens are views into it
+        Command command(std::move(input));
 
-        // fetch first token (will be command)
-        std::string command;
-        ss >> command; 
+        // blank lines and # comments are skipped in scripts
+        if(!this->interactive && (command.getCommand().empty() || command.getCommand().front() == '#')) continue;
 
         // valid command
-        if(Operation::commandList.find(command) != Operation::commandList.end()) {
-            std::list<std::string> args;
-
-            std::regex re("\"[^\"]*\"|\\S+");
-
-            std::sregex_iterator it(input.begin(), input.end(), re);
-            std::sregex_iterator end;
-
-            while (it != end) {
-                std::string str = it->str();
-                if (str.front() == '"' && str.back() == '"') {
-                    str = str.substr(1, str.length() - 2);
-                }
-                args.push_back(str);
-                ++it;
-            }
-            args.pop_front();
-            return Command(command, args);
+        if(Operation::find(command.getCommand()) != nullptr) {
+            return command;
         }
         // invalid command
-        else {
+        else if(this->interactive) {
             std::cout << "Invalid Command\n";
-            ss.clear();
+        }
+        else {
+            ++this->failures;
+            this->report(command, Error::BADCMD, 0);
         }
     }
 
@@ -71,62 +139,13 @@ Command Shell::fetchCommand() {
 }
 
 error_t Shell::executeCommand(const Command& c) {
-    switch(Operation::commandList.at(c.getCommand())) {
-    case Operation::c_exit : {
-        return Operation::shell_exit();
-    }
-    case Operation::c_help : { 
-        return Operation::help();
-    }
-    case Operation::c_status : { 
-        return Operation::status(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_create : {
-        return Operation::create(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_depart : {
-        return Operation::depart(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_arrive : {
-        return Operation::arrive(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_passengers : {
-        return Operation::passengers(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_list : {
-        return Operation::list(this->getAPI());
-    }
-    case Operation::c_delay : {
-        return Operation::delay(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_mealTypes : {
-        return Operation::mealTypes(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_meals : {
-        return Operation::meals(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_changeStatus : {
-        return Operation::changeStatus(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_addCargo : {
-        return Operation::addCargo(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_removeCargo : {
-        return Operation::removeCargo(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_checkCargo : {
-        return Operation::checkCargo(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_changeDestination : {
-        return Operation::changeDestination(this->getAPI(), c.getArgs());
-    }
-    case Operation::c_changeOrigin : {
-        return Operation::changeOrigin(this->getAPI(), c.getArgs());
-    }
-    default : {
-        return Error::BADCMD;
-    }
-    }
+    return Shell::dispatch(this->getAPI(), c);
+}
+
+error_t Shell::dispatch(const API& api, const Command& c) {
+    const CommandSpec* command = Operation::find(c.getCommand());
+    if(command == nullptr) return Error::BADCMD;
+    return command->run(api, c.getArgs());
 }
 
 API Shell::login() {
@@ -0,0 +1,367 @@
+#include "../inc/statement.h"
+
+#include <cctype>
+#include <stdexcept>
+
+std::atomic<unsigned long> Statement::prepared(0);
+std::atomic<unsigned long> Statement::executed(0);
+
+// resolves $1 to the flight with that number, preferring an active one; statements
+// built on it select target.active first so the caller can tell a missing flight
+// from a finished one without a separate lookup
+static const std::string targetFlight =
+    "WITH target AS ( "
+        "SELECT Flight.id, (StatusType.name NOT LIKE 'Arrived' "
+            "AND StatusType.name NOT LIKE 'Cancelled') AS active "
+        "FROM Flight "
+            "JOIN StatusType ON (Flight.status_id = StatusType.id) "
+        "WHERE flight_number = $1 "
+        "ORDER BY active DESC, departure_time DESC "
+        "LIMIT 1 "
+    ") ";
+
+// the target flight row locked for the rest of the transaction with the room
+// left on it, FOR UPDATE waits for anyone else loading the flight and then
+// reads the row they committed, so two loads can't both take the last of it
+static const std::string lockedFlight =
+    "locked AS ( "
+        "SELECT Flight.id, "
+            "AirplaneType.max_passengers - Flight.passenger_count AS seats, "
+            "AirplaneType.max_cargo - Flight.cargo_weight_total AS cargo_room "
+        "FROM target "
+            "JOIN Flight ON (Flight.id = target.id) "
+            "JOIN AirplaneType ON (AirplaneType.id = Flight.airplane_id) "
+        "WHERE target.active "
+        "FOR UPDATE OF Flight "
+    ") ";
+
+// maps statement name to its sql
+const std::map<std::string, std::string> Statement::sql = {
+    {"get_flight", targetFlight +
+        "SELECT target.active, flight_number, departure_time, arrival_time, passenger_count as num_passengers, letter as Terminal, gate_number, statustype.name as status, airplanetype.name as plane_type, airlinetype.name as airline, origin.icao as origin, destination.icao as destination "
+        "FROM target "
+            "JOIN flight ON (flight.id = target.id) "
+            "JOIN gatetype ON (flight.gate_id = gatetype.id) "
+            "JOIN terminaltype ON (gatetype.terminal_id = terminaltype.id) "
+            "JOIN statustype ON (flight.status_id = statustype.id) "
+            "JOIN airplanetype ON (flight.airplane_id = airplanetype.id) "
+            "JOIN airlinetype ON (flight.airline_id = airlinetype.id) "
+            "JOIN locationtype AS origin ON (flight.origin_id = origin.id) "
+            "JOIN locationtype AS destination ON (flight.destination_id = destination.id);"
+    },
+    {"get_flights",
+        // get_flight for every number in the $1 array in one go, a row per
+        // element in array order with the number asked for last, the active
+        // column is null when no flight has that number
+        "WITH requested AS ( "
+            "SELECT number, position FROM unnest($1::VARCHAR[]) WITH ORDINALITY AS requested(number, position) "
+        "), target AS ( "
+            "SELECT DISTINCT ON (flight_number) Flight.id, flight_number, (StatusType.name NOT LIKE 'Arrived' "
+                "AND StatusType.name NOT LIKE 'Cancelled') AS active "
+            "FROM Flight "
+                "JOIN StatusType ON (Flight.status_id = StatusType.id) "
+            "WHERE flight_number = ANY($1::VARCHAR[]) "
+            "ORDER BY flight_number, active DESC, departure_time DESC "
+        ") "
+        "SELECT target.active, flight.flight_number, departure_time, arrival_time, passenger_count as num_passengers, letter as Terminal, gate_number, statustype.name as status, airplanetype.name as plane_type, airlinetype.name as airline, origin.icao as origin, destination.icao as destination, requested.number "
+        "FROM requested "
+            "LEFT JOIN target ON (target.flight_number = requested.number) "
+            "LEFT JOIN flight ON (flight.id = target.id) "
+            "LEFT JOIN gatetype ON (flight.gate_id = gatetype.id) "
+            "LEFT JOIN terminaltype ON (gatetype.terminal_id = terminaltype.id) "
+            "LEFT JOIN statustype ON (flight.status_id = statustype.id) "
+            "LEFT JOIN airplanetype ON (flight.airplane_id = airplanetype.id) "
+            "LEFT JOIN airlinetype ON (flight.airline_id = airlinetype.id) "
+            "LEFT JOIN locationtype AS origin ON (flight.origin_id = origin.id) "
+            "LEFT JOIN locationtype AS destination ON (flight.destination_id = destination.id) "
+        "ORDER BY requested.position;"
+    },
+    {"CreateFlight",
+        // every id comes from the reference cache, $5 is Standby and nothing is
+        // inserted while a flight with the number is neither $10 Arrived nor $11 Cancelled
+        "INSERT INTO Flight(id, flight_number, departure_time, arrival_time, gate_id, status_id, airplane_id, destination_id, origin_id, airline_id) "
+        "SELECT (SELECT NEXTVAL('flight_id_seq')), "
+            "$1, $2::TIMESTAMP, $3::TIMESTAMP, $4::INTEGER, $5::INTEGER, $6::INTEGER, $7::INTEGER, $8::INTEGER, $9::INTEGER "
+        "WHERE NOT EXISTS (SELECT 1 FROM Flight "
+            "WHERE flight_number = $1 "
+                "AND status_id NOT IN ($10::INTEGER, $11::INTEGER)); "
+    },
+    {"get_destinations",
+        // status ids 6 and 7 are Arrived and Cancelled, written out so the
+        // partial indexes on active flights apply, ReferenceCache checks them
+        "SELECT flight_number, destination.icao FROM flight "
+            "JOIN LocationType AS origin ON (flight.origin_id = origin.id) "
+            "JOIN LocationType AS destination ON (flight.destination_id = destination.id) "
+        "WHERE origin.icao = $1 "
+            "AND flight.status_id NOT IN (6, 7)"
+        ";"
+    },
+    {"get_arrivals",
+        "SELECT flight_number, origin.icao FROM flight "
+            "JOIN LocationType AS origin ON (flight.origin_id = origin.id) "
+            "JOIN LocationType AS destination ON (flight.destination_id = destination.id) "
+        "WHERE destination.icao = $1 "
+            "AND flight.status_id NOT IN (6, 7)"
+        ";"
+    },
+    {"add_cargo", targetFlight + ", " + lockedFlight + ", "
+        "inserted AS ( "
+            "INSERT INTO Cargo(id, flight_id, weight_lb, barcode) "
+            "SELECT (SELECT NEXTVAL('cargo_id_seq')), locked.id, $2::NUMERIC, $3::TEXT "
+            "FROM locked WHERE $2::NUMERIC <= locked.cargo_room "
+            "RETURNING id "
+        "), "
+        // the flight's running total moves with the insert
+        "counted AS ( "
+            "UPDATE Flight SET cargo_weight_total = cargo_weight_total + $2::NUMERIC "
+            "FROM target "
+            "WHERE Flight.id = target.id AND EXISTS (SELECT 1 FROM inserted) "
+        ") "
+        "SELECT target.active, (SELECT count(*) FROM inserted), locked.cargo_room "
+        "FROM target LEFT JOIN locked ON (true);"
+    },
+    {"all_flights",
+        "SELECT flight_number, departure_time, arrival_time, GateType.gate_number, TerminalType.letter, "
+        "StatusType.name, c1.name AS destination, c2.name AS origin, AirlineType.name, Flight.id "
+        "FROM Flight "
+            "JOIN StatusType ON (Flight.status_id = StatusType.id) "
+            "JOIN GateType ON (Flight.gate_id = GateType.id) "
+            "JOIN TerminalType ON (GateType.terminal_id = TerminalType.id) "
+            "JOIN LocationType dest ON (dest.id = Flight.destination_id) "
+            "JOIN LocationType origin ON (origin.id = Flight.origin_id) "
+            "JOIN CityType c1 ON (dest.city_id = c1.id ) "
+            "JOIN CityType c2 ON (origin.city_id = c2.id) "
+            "JOIN AirlineType ON (Flight.airline_id = AirlineType.id) "
+        // status id 6 is Arrived as ReferenceCache checks, pages continue after the $1 departure time
+        // and $2 flight id of the last row, the id breaks ties between flights
+        // leaving at the same time, and a $3 limit of 0 means every flight
+        "WHERE Flight.status_id <> 6 "
+            "AND (departure_time, Flight.id) > ($1::TIMESTAMP, $2::INTEGER) "
+        "ORDER BY departure_time, Flight.id "
+        "LIMIT NULLIF($3::BIGINT, 0) OFFSET $4::BIGINT "
+        ";"
+    },
+    {"delay_flight", targetFlight + ", "
+        "delayed AS ( "
+            "UPDATE flight "
+            "SET "
+                "departure_time = departure_time + $2::INTERVAL, "
+                "arrival_time = arrival_time + $2::INTERVAL "
+            "FROM target "
+            "WHERE flight.id = target.id AND target.active "
+            "RETURNING flight.id "
+        ") "
+        "SELECT target.active, (SELECT count(*) FROM delayed) FROM target;"
+    },
+    {"getMeals", targetFlight +
+        "SELECT target.active, MealType.name "
+        "FROM target "
+            "LEFT JOIN MealToFlight ON (MealToFlight.flight_id = target.id) "
+            "LEFT JOIN MealType ON (MealToFlight.meal_id = MealType.id) "
+        "ORDER BY MealType.name"
+        ";"
+    },
+    {"check_cargo", targetFlight +
+        "SELECT target.active, Flight.cargo_weight_total "
+        "FROM target "
+            "JOIN Flight ON (Flight.id = target.id)"
+        ";"
+    },
+    {"cargo_capacity", targetFlight +
+        "SELECT target.active, target.id, AirplaneType.max_cargo, Flight.cargo_weight_total "
+        "FROM target "
+            "JOIN Flight ON (Flight.id = target.id) "
+            "JOIN AirplaneType ON (AirplaneType.id = Flight.airplane_id) "
+        // holds the flight until the load commits so two loads can't both fit
+        "FOR UPDATE OF Flight"
+        ";"
+    },
+    {"CheckMealType", targetFlight +
+        "SELECT Distinct target.active, MealCategoryType.category "
+        "FROM target "
+            "LEFT JOIN MealToFlight ON (MealToFlight.flight_id = target.id) "
+            "LEFT JOIN MealType ON (MealType.id = MealToFlight.meal_id) "
+            "LEFT JOIN MealToCategory ON (MealToCategory.meal_id = MealType.id) "
+            "LEFT JOIN MealCategoryType ON (MealCategoryType.id = MealToCategory.category_id) "
+        "ORDER BY MealCategoryType.category; "
+    },
+    {"add_passengers", targetFlight + ", "
+        // $2 is an array of generated barcodes, only as many as there are
+        // seats left are boarded and any already taken are skipped so the
+        // caller can top up the shortfall
+        + lockedFlight + ", "
+        "inserted AS ( "
+            "INSERT INTO Passenger (flight_id, barcode) "
+            "SELECT locked.id, barcode "
+            "FROM locked CROSS JOIN unnest($2::TEXT[]) WITH ORDINALITY AS generated (barcode, n) "
+            "WHERE generated.n <= locked.seats "
+            "ON CONFLICT (barcode) DO NOTHING "
+            "RETURNING barcode "
+        "), "
+        "counted AS ( "
+            "UPDATE Flight SET passenger_count = passenger_count + (SELECT count(*) FROM inserted) "
+            "FROM target "
+            "WHERE Flight.id = target.id AND EXISTS (SELECT 1 FROM inserted) "
+        ") "
+        "SELECT target.active, inserted.barcode, locked.seats "
+        "FROM target LEFT JOIN locked ON (true) LEFT JOIN inserted ON (true);"
+    },
+    {"remove_passengers", targetFlight + ", "
+        "removed AS ( "
+            "DELETE FROM Passenger "
+            "WHERE id IN ( "
+                "SELECT Passenger.id FROM Passenger JOIN target ON (Passenger.flight_id = target.id) "
+                "WHERE target.active "
+                "ORDER BY Passenger.id DESC "
+                "LIMIT $2::INTEGER "
+            ") "
+            "RETURNING barcode "
+        "), "
+        "counted AS ( "
+            "UPDATE Flight SET passenger_count = passenger_count - (SELECT count(*) FROM removed) "
+            "FROM target "
+            "WHERE Flight.id = target.id AND EXISTS (SELECT 1 FROM removed) "
+        ") "
+        "SELECT target.active, removed.barcode FROM target LEFT JOIN removed ON (true);"
+    },
+    {"update_status", targetFlight + ", "
+        // the new status's name, null when the flight wasn't changed
+        "updated AS ( "
+            "UPDATE Flight SET status_id = $2::INTEGER "
+            "FROM target "
+            "WHERE Flight.id = target.id AND target.active "
+            "RETURNING Flight.status_id "
+        ") "
+        "SELECT target.active, StatusType.name "
+        "FROM target "
+            "LEFT JOIN updated ON (true) "
+            "LEFT JOIN StatusType ON (StatusType.id = updated.status_id);"
+    },
+    {"remove_cargo", targetFlight + ", "
+        "removed AS ( "
+            "DELETE FROM Cargo USING target "
+            "WHERE Cargo.flight_id = target.id AND target.active "
+                "AND barcode = $2 "
+            "RETURNING Cargo.id, Cargo.weight_lb "
+        "), "
+        "counted AS ( "
+            "UPDATE Flight SET cargo_weight_total = cargo_weight_total - (SELECT SUM(weight_lb) FROM removed) "
+            "FROM target "
+            "WHERE Flight.id = target.id AND EXISTS (SELECT 1 FROM removed) "
+        ") "
+        "SELECT target.active, (SELECT count(*) FROM removed) FROM target;"
+    },
+    {"update_destination", targetFlight + ", "
+        // only a flight leaving the $5 home airport that is $3 Standby or $4
+        // Delayed, the new destination's city is null when it wasn't changed
+        "updated AS ( "
+            "UPDATE Flight SET destination_id = $2::INTEGER "
+            "FROM target "
+            "WHERE Flight.id = target.id AND target.active "
+                "AND Flight.status_id IN ($3::INTEGER, $4::INTEGER) "
+                "AND Flight.origin_id = $5::INTEGER "
+            "RETURNING Flight.destination_id "
+        ") "
+        "SELECT target.active, CityType.name "
+        "FROM target "
+            "LEFT JOIN updated ON (true) "
+            "LEFT JOIN LocationType ON (LocationType.id = updated.destination_id) "
+            "LEFT JOIN CityType ON (CityType.id = LocationType.city_id);"
+    },
+    {"update_origin", targetFlight + ", "
+        // only a flight arriving at the $5 home airport that is $3 Standby or
+        // $4 Delayed, the new origin's city is null when it wasn't changed
+        "updated AS ( "
+            "UPDATE Flight SET origin_id = $2::INTEGER "
+            "FROM target "
+            "WHERE Flight.id = target.id AND target.active "
+                "AND Flight.status_id IN ($3::INTEGER, $4::INTEGER) "
+                "AND Flight.destination_id = $5::INTEGER "
+            "RETURNING Flight.origin_id "
+        ") "
+        "SELECT target.active, CityType.name "
+        "FROM target "
+            "LEFT JOIN updated ON (true) "
+            "LEFT JOIN LocationType ON (LocationType.id = updated.origin_id) "
+            "LEFT JOIN CityType ON (CityType.id = LocationType.city_id);"
+    },
+    {"recount_cargo",
+        // after loadCargo's COPY, run while cargo_capacity's lock on the flight is held
+        "UPDATE Flight "
+        "SET cargo_weight_total = (SELECT COALESCE(SUM(weight_lb), 0) FROM Cargo WHERE Cargo.flight_id = Flight.id) "
+        "WHERE Flight.id = $1::INTEGER; "
+    },
+    {"recount",
+        // flights whose counters disagree with their passengers and cargo,
+        // corrected when $1 is true, no Passenger row changed so the
+        // correction announces itself on flight_changed
+        "WITH actual AS ( "
+            "SELECT Flight.id, flight_number, passenger_count, cargo_weight_total, "
+                "COALESCE(passengers.total, 0) AS passengers, COALESCE(cargo.total, 0) AS cargo "
+            "FROM Flight "
+                "LEFT JOIN (SELECT flight_id, count(*) AS total FROM Passenger GROUP BY flight_id) AS passengers ON (passengers.flight_id = Flight.id) "
+                "LEFT JOIN (SELECT flight_id, SUM(weight_lb) AS total FROM Cargo GROUP BY flight_id) AS cargo ON (cargo.flight_id = Flight.id) "
+        "), "
+        "wrong AS ( "
+            "SELECT * FROM actual "
+            "WHERE passenger_count <> passengers OR cargo_weight_total <> cargo "
+        "), "
+        "fixed AS ( "
+            "UPDATE Flight SET passenger_count = wrong.passengers, cargo_weight_total = wrong.cargo "
+            "FROM wrong "
+            "WHERE Flight.id = wrong.id AND $1::BOOLEAN "
+            "RETURNING pg_notify('flight_changed', Flight.flight_number) "
+        ") "
+        "SELECT flight_number, passenger_count, passengers, cargo_weight_total, cargo "
+        "FROM wrong "
+        "ORDER BY flight_number; "
+    },
+};
+
+void Statement::prepare(PooledConnection& connection, const std::string& name) {
+    auto& names = connection.preparedNames();
+    if(names.find(name) != names.end()) return;
+    Stats::Timer timer(Stats::prepare);
+    connection->prepare(name, Statement::sql.at(name));
+    Stats::roundTrip(0);
+    names.insert(name);
+    ++prepared;
+}
+
+pqxx::result Statement::execParams(pqxx::transaction_base& query, PooledConnection& connection, const std::string& name, const std::vector<std::string>& params) {
+    switch(params.size()) {
+    case 0 : return Statement::exec(query, connection, name);
+    case 1 : return Statement::exec(query, connection, name, params[0]);
+    case 2 : return Statement::exec(query, connection, name, params[0], params[1]);
+    case 3 : return Statement::exec(query, connection, name, params[0], params[1], params[2]);
+    default : throw std::invalid_argument("too many parameters for " + name);
+    }
+}
+
+std::string Statement::expand(const pqxx::transaction_base& query, const std::string& name, const std::vector<std::string>& params) {
+    const std::string& text = Statement::sql.at(name);
+    std::string out;
+    out.reserve(text.size() + 32 * params.size());
+    for(std::size_t i = 0; i < text.size(); ++i) {
+        if(text[i] != '$' || i + 1 >= text.size() || !std::isdigit(static_cast<unsigned char>(text[i + 1]))) {
+            out += text[i];
+            continue;
+        }
+        std::size_t n = 0;
+        while(i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1]))) {
+            n = n * 10 + (text[++i] - '0');
+        }
+        out += query.quote(params.at(n - 1));
+    }
+    ++executed;
+    return out;
+}
+
+void Statement::commit(pqxx::transaction_base& query) {
+    Stats::Timer timer(Stats::execute);
+    query.commit();
+    Stats::roundTrip(0);
+}
+
+unsigned long Statement::prepareCount() { return prepared; }
+unsigned long Statement::executeCount() { return executed; }
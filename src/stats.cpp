@@ -0,0 +1,78 @@
+#include "../inc/stats.h"
+
+#include <fstream>
+#include <iomanip>
+
+std::mutex Stats::mutex;
+std::map<std::string, Stats::Record, std::less<>> Stats::records;
+thread_local Stats::Record Stats::current;
+
+void Stats::begin() {
+    current = Record();
+}
+
+void Stats::end(std::string_view command, double wall) {
+    std::size_t bucket = 0;
+    for(double limit = 1; bucket + 1 < buckets && wall * 1000 >= limit; limit *= 2) ++bucket;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = records.find(command);
+    if(found == records.end()) found = records.emplace(std::string(command), Record()).first;
+    Record& record = found->second;
+    ++record.count;
+    record.wall += wall;
+    for(int i = 0; i < phases; ++i) record.phase[i] += current.phase[i];
+    record.roundTrips += current.roundTrips;
+    record.rows += current.rows;
+    ++record.histogram[bucket];
+}
+
+void Stats::add(int phase, double ms) {
+    current.phase[phase] += ms;
+}
+
+void Stats::roundTrip(std::size_t rows) {
+    ++current.roundTrips;
+    current.rows += rows;
+}
+
+// averages per call, output is whatever the database phases don't account for
+void Stats::print(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(records.empty()) return;
+
+    os << std::left << std::setw(18) << "command" << std::right << std::setw(7) << "calls"
+       << std::setw(10) << "wall ms" << std::setw(10) << "connect" << std::setw(10) << "prepare"
+       << std::setw(10) << "execute" << std::setw(10) << "output" << std::setw(8) << "trips" << std::setw(8) << "rows" << '\n';
+    for(const auto& [command, record] : records) {
+        double n = record.count;
+        double database = record.phase[connect] + record.phase[prepare] + record.phase[execute];
+        os << std::left << std::setw(18) << command << std::right << std::setw(7) << record.count
+           << std::fixed << std::setprecision(3)
+           << std::setw(10) << record.wall / n
+           << std::setw(10) << record.phase[connect] / n
+           << std::setw(10) << record.phase[prepare] / n
+           << std::setw(10) << record.phase[execute] / n
+           << std::setw(10) << (record.wall - database) / n
+           << std::setprecision(1)
+           << std::setw(8) << record.roundTrips / n
+           << std::setw(8) << record.rows / n << '\n';
+    }
+    os.unsetf(std::ios::floatfield);
+    os << std::setprecision(6);
+}
+
+bool Stats::dump(const std::string& path) {
+    std::ofstream file(path);
+    if(!file) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file << "command,under_us,count\n";
+    for(const auto& [command, record] : records) {
+        unsigned long limit = 1;
+        for(std::size_t i = 0; i < buckets; ++i, limit *= 2) {
+            if(record.histogram[i] != 0) file << command << ',' << limit << ',' << record.histogram[i] << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,123 @@
+#include "../inc/tablewriter.h"
+
+int TableWriter::format = TableWriter::text;
+
+TableWriter::TableWriter(std::ostream& out, std::vector<Column> columns, int mode)
+: out(out), columns(std::move(columns)), mode(mode) {
+    this->buffer.reserve(TableWriter::batch + 1024);
+}
+
+TableWriter::~TableWriter() {
+    this->flush();
+}
+
+void TableWriter::header() {
+    if(this->mode == TableWriter::jsonl) return;
+    std::size_t total = 0;
+    for(const auto& column : this->columns) {
+        // headings go through the csv quoting and text padding like any field
+        bool keyed = this->mode == TableWriter::csv;
+        this->field(keyed ? column.key : column.label);
+        total += column.width;
+    }
+    this->endRow();
+    if(this->mode == TableWriter::text) {
+        this->buffer.append(total, '-');
+        this->buffer += '\n';
+    }
+}
+
+// whatever has to come before the next field's value
+void TableWriter::separator() {
+    if(this->mode == TableWriter::csv && this->column > 0) this->buffer += ',';
+    if(this->mode == TableWriter::jsonl) {
+        this->buffer += this->column == 0 ? '{' : ',';
+        this->buffer += '"';
+        this->buffer += this->columns[this->column].key;
+        this->buffer += "\":";
+    }
+}
+
+// a string value with csv or json escaping
+void TableWriter::quoted(std::string_view value) {
+    if(this->mode == TableWriter::csv) {
+        if(value.find_first_of(",\"\n\r") == std::string_view::npos) {
+            this->buffer += value;
+            return;
+        }
+        this->buffer += '"';
+        for(char c : value) {
+            if(c == '"') this->buffer += '"';
+            this->buffer += c;
+        }
+        this->buffer += '"';
+        return;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    this->buffer += '"';
+    for(char c : value) {
+        if(c == '"' || c == '\\') {
+            this->buffer += '\\';
+            this->buffer += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20) {
+            this->buffer += "\\u00";
+            this->buffer += hex[c >> 4];
+            this->buffer += hex[c & 0xf];
+        }
+        else this->buffer += c;
+    }
+    this->buffer += '"';
+}
+
+TableWriter& TableWriter::field(std::string_view value) {
+    this->separator();
+    if(this->mode == TableWriter::text) {
+        std::size_t width = this->columns[this->column].width;
+        if(value.size() < width) this->buffer.append(width - value.size(), ' ');
+        this->buffer += value;
+    }
+    else this->quoted(value);
+    ++this->column;
+    return *this;
+}
+
+TableWriter& TableWriter::number(std::string_view value) {
+    // NaN and Infinity aren't json numbers, they stay strings
+    bool plain = !value.empty() && value.find_first_not_of("-0123456789.") == std::string_view::npos;
+    if(this->mode == TableWriter::text || !plain) return this->field(value);
+    this->separator();
+    this->buffer += value;
+    ++this->column;
+    return *this;
+}
+
+TableWriter& TableWriter::null() {
+    if(this->mode != TableWriter::jsonl) return this->field(std::string_view());
+    this->separator();
+    this->buffer += "null";
+    ++this->column;
+    return *this;
+}
+
+void TableWriter::endRow() {
+    if(this->mode == TableWriter::jsonl) this->buffer += this->column == 0 ? "{}" : "}";
+    this->buffer += '\n';
+    this->column = 0;
+    if(this->buffer.size() >= TableWriter::batch) this->flush();
+}
+
+void TableWriter::flush() {
+    if(!this->buffer.empty()) this->out.write(this->buffer.data(), this->buffer.size());
+    this->buffer.clear();
+    this->out.flush();
+}
+
+bool TableWriter::parseFormat(std::string_view name, int& mode) {
+    if(name == "text") mode = TableWriter::text;
+    else if(name == "csv") mode = TableWriter::csv;
+    else if(name == "jsonl") mode = TableWriter::jsonl;
+    else return false;
+    return true;
+}